@@ -0,0 +1,101 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "result-assimilator.h"
+
+inline void help() {
+    std::cerr << "Usage:" << std::endl;
+    std::cerr << "assimilator [--threads N] [--segment-rows N] store results" << std::endl;
+    std::cerr << "results is a directory with result archives or - to read their paths from standard input" << std::endl;
+}
+
+inline bool parse_count(const char* str, uint64_t& value) {
+    char* end = nullptr;
+    value = std::strtoull(str, &end, 10);
+    return end != str && *end == '\0' && value > 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        uint64_t threads = std::max(1u, std::thread::hardware_concurrency());
+        uint64_t segment_rows = 100000;
+        std::vector<std::string> paths;
+        for (auto i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                if (!parse_count(argv[++i], threads)) {
+                    std::cerr << "Wrong number of threads: " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else if (std::strcmp(argv[i], "--segment-rows") == 0 && i + 1 < argc) {
+                if (!parse_count(argv[++i], segment_rows)) {
+                    std::cerr << "Wrong number of segment rows: " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else {
+                paths.emplace_back(argv[i]);
+            }
+        }
+
+        if (paths.size() != 2) {
+            help();
+            return 1;
+        }
+
+        result_assimilator assimilator(paths[0], static_cast<size_t>(segment_rows), static_cast<int>(threads));
+        if (!assimilator.open()) {
+            return 1;
+        }
+
+        if (paths[1] == "-") {
+            return assimilator.run([](std::filesystem::path& result) {
+                std::string line;
+                while (std::getline(std::cin, line)) {
+                    if (!line.empty()) {
+                        result = line;
+                        return true;
+                    }
+                }
+                return false;
+            }) ? 0 : 1;
+        }
+
+        auto it = std::filesystem::directory_iterator(paths[1]);
+        return assimilator.run([&it](std::filesystem::path& result) {
+            for (; it != std::filesystem::directory_iterator(); ++it) {
+                if (it->is_regular_file() && it->path().extension() == ".zip") {
+                    result = it->path();
+                    ++it;
+                    return true;
+                }
+            }
+            return false;
+        }) ? 0 : 1;
+    }
+    catch (std::exception& ex) {
+        std::cerr << "Exception was thrown while running assimilator: " << ex.what() << std::endl;
+        return 1;
+    }
+}
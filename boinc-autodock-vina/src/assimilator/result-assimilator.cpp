@@ -0,0 +1,571 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "zip_helper/zip-reader.h"
+#include "zip_helper/zip-writer.h"
+
+#include "common/results.h"
+
+#include "result-assimilator.h"
+
+namespace {
+const std::string index_file = "ligands.idx";
+const std::string segment_prefix = "segment-";
+const std::string segment_extension = ".zip";
+const std::string temporary_extension = ".tmp";
+
+bool starts_with(const std::string& value, const std::string& prefix) {
+    return value.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool ends_with(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// FNV-1a, names of results are not kept in memory
+uint64_t name_hash(const std::string& name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool parse_segment_number(const std::filesystem::path& file, uint64_t& segment) {
+    const auto& name = file.filename().string();
+    if (!starts_with(name, segment_prefix) || !ends_with(name, segment_extension)) {
+        return false;
+    }
+    const auto& number = name.substr(segment_prefix.size(), name.size() - segment_prefix.size() - segment_extension.size());
+    char* end = nullptr;
+    segment = std::strtoull(number.c_str(), &end, 10);
+    return !number.empty() && *end == '\0';
+}
+
+// first MODEL of Vina poses with its affinity
+bool read_best_pose(const std::string& poses, float& affinity, std::string& pose) {
+    size_t begin = 0;
+    while (begin < poses.size() && !starts_with(poses.substr(begin, 5), "MODEL")) {
+        begin = poses.find('\n', begin);
+        if (begin == std::string::npos) {
+            return false;
+        }
+        ++begin;
+    }
+    if (begin >= poses.size()) {
+        return false;
+    }
+
+    auto end = poses.find("\nENDMDL", begin);
+    end = end == std::string::npos ? poses.size() : poses.find('\n', end + 1);
+    pose = poses.substr(begin, end == std::string::npos ? std::string::npos : end - begin + 1);
+
+    const std::string remark = "REMARK VINA RESULT:";
+    const auto position = pose.find(remark);
+    if (position == std::string::npos) {
+        return false;
+    }
+    const auto* value = pose.c_str() + position + remark.size();
+    char* value_end = nullptr;
+    affinity = std::strtof(value, &value_end);
+    return value_end != value;
+}
+
+void put_uint64(std::string& data, const uint64_t& value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t get_uint64(const char* data) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+void put_float(std::string& data, const float& value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+        data.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+}
+
+float get_float(const char* data) {
+    uint32_t bits = 0;
+    for (size_t i = 0; i < sizeof(bits); ++i) {
+        bits |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::vector<std::string> split_lines(const std::string& content) {
+    std::vector<std::string> lines;
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.emplace_back(std::move(line));
+    }
+    return lines;
+}
+
+std::string index_name(const assimilated_ligand& ligand) {
+    return ligand.target.empty() ? ligand.ligand : ligand.ligand + " " + ligand.target;
+}
+
+bool append_index(const std::filesystem::path& store, const uint64_t& segment, const std::vector<std::string>& ligands) {
+    std::ofstream index(store / index_file, std::ios::binary | std::ios::app);
+    if (!index) {
+        std::cerr << "Failed to open <" << index_file << ">" << std::endl;
+        return false;
+    }
+    std::string lines;
+    for (size_t row = 0; row < ligands.size(); ++row) {
+        lines += std::to_string(segment) + " " + std::to_string(row) + " " + ligands[row] + "\n";
+    }
+    return static_cast<bool>(index.write(lines.data(), static_cast<std::streamsize>(lines.size())).flush());
+}
+}
+
+result_assimilator::result_assimilator(const std::filesystem::path& store, const size_t& segment_rows, const int& threads) :
+    store(store), segment_rows(std::max<size_t>(1, segment_rows)), threads(std::max(1, threads)) {
+}
+
+std::filesystem::path result_assimilator::segment_path(const std::filesystem::path& store, const uint64_t& segment) {
+    std::ostringstream name;
+    name << segment_prefix << std::setw(6) << std::setfill('0') << segment << segment_extension;
+    return store / name.str();
+}
+
+bool result_assimilator::open() {
+    std::lock_guard lock(mutex);
+
+    if (!exists(store)) {
+        create_directories(store);
+    }
+
+    std::vector<uint64_t> segments;
+    for (const auto& file : std::filesystem::directory_iterator(store)) {
+        uint64_t segment;
+        if (ends_with(file.path().filename().string(), temporary_extension)) {
+            std::filesystem::remove(file.path());
+        }
+        else if (parse_segment_number(file.path(), segment)) {
+            segments.push_back(segment);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+
+    for (const auto& segment : segments) {
+        const zip_reader reader(segment_path(store, segment));
+        std::string content;
+        if (!reader.is_open() || !reader.read("sources", content)) {
+            std::cerr << "Failed to read <" << segment_path(store, segment).filename().string() << ">" << std::endl;
+            return false;
+        }
+        for (const auto& source : split_lines(content)) {
+            assimilated.insert(name_hash(source));
+        }
+        next_segment = segment + 1;
+        next_written = next_segment;
+    }
+
+    // lines of the last indexed segment could be written partially, so it is indexed again
+    uint64_t last_indexed = 0;
+    std::streamoff last_indexed_offset = 0;
+    {
+        std::ifstream index(store / index_file, std::ios::binary);
+        std::string line;
+        std::streamoff offset = 0;
+        while (index && std::getline(index, line)) {
+            if (index.eof()) {
+                break;
+            }
+            const auto segment = std::strtoull(line.c_str(), nullptr, 10);
+            if (segment > last_indexed) {
+                last_indexed = segment;
+                last_indexed_offset = offset;
+            }
+            offset += static_cast<std::streamoff>(line.size()) + 1;
+        }
+        if (exists(store / index_file)) {
+            std::filesystem::resize_file(store / index_file, static_cast<uintmax_t>(last_indexed_offset));
+        }
+    }
+
+    for (const auto& segment : segments) {
+        if (segment < last_indexed) {
+            continue;
+        }
+        std::vector<assimilated_ligand> ligands;
+        if (!read_segment(segment_path(store, segment), ligands)) {
+            return false;
+        }
+        std::vector<std::string> names;
+        for (const auto& ligand : ligands) {
+            names.emplace_back(index_name(ligand));
+        }
+        if (!append_index(store, segment, names)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool result_assimilator::is_assimilated(const std::string& result) const {
+    std::lock_guard lock(mutex);
+    return assimilated.find(name_hash(result)) != assimilated.cend();
+}
+
+bool result_assimilator::add(const std::string& result, std::vector<assimilated_ligand> ligands) {
+    pending_segment segment;
+    {
+        std::lock_guard lock(mutex);
+        if (!assimilated.insert(name_hash(result)).second) {
+            return true;
+        }
+        sources.push_back(result);
+        std::move(ligands.begin(), ligands.end(), std::back_inserter(rows));
+        if (rows.size() < segment_rows) {
+            return true;
+        }
+        take_segment(segment);
+    }
+    return write_segment(segment);
+}
+
+bool result_assimilator::flush() {
+    pending_segment segment;
+    {
+        std::lock_guard lock(mutex);
+        if (sources.empty()) {
+            return true;
+        }
+        take_segment(segment);
+    }
+    return write_segment(segment);
+}
+
+void result_assimilator::take_segment(pending_segment& segment) {
+    segment.number = next_segment++;
+    segment.rows.swap(rows);
+    segment.sources.swap(sources);
+}
+
+bool result_assimilator::write_segment(pending_segment& segment) {
+    std::string workunit;
+    std::string target;
+    std::string ligand;
+    std::string affinity;
+    std::string pose;
+    std::string pose_offsets;
+    std::vector<std::string> names;
+    for (const auto& row : segment.rows) {
+        workunit += row.workunit + "\n";
+        target += row.target + "\n";
+        ligand += row.ligand + "\n";
+        put_float(affinity, row.affinity);
+        put_uint64(pose_offsets, pose.size());
+        pose += row.pose;
+        names.push_back(index_name(row));
+    }
+    put_uint64(pose_offsets, pose.size());
+    std::vector<assimilated_ligand>().swap(segment.rows);
+    std::string source;
+    for (const auto& s : segment.sources) {
+        source += s + "\n";
+    }
+
+    const auto& path = segment_path(store, segment.number);
+    auto temporary_path = path;
+    temporary_path += temporary_extension;
+    auto result = true;
+    try {
+        zip_writer writer(temporary_path, {}, threads);
+        if (!writer.is_open() ||
+            !writer.add("workunit", std::move(workunit)) ||
+            !writer.add("target", std::move(target)) ||
+            !writer.add("ligand", std::move(ligand)) ||
+            !writer.add("affinity", std::move(affinity)) ||
+            !writer.add("pose", std::move(pose)) ||
+            !writer.add("pose_offsets", std::move(pose_offsets)) ||
+            !writer.add("sources", std::move(source)) ||
+            !writer.close()) {
+            std::cerr << "Failed to write <" << path.filename().string() << ">" << std::endl;
+            result = false;
+        }
+    }
+    catch (const std::exception& ex) {
+        // the turn of the segment has to be taken anyway, so later segments are not waiting for it
+        std::cerr << "Failed to write <" << path.filename().string() << ">: " << ex.what() << std::endl;
+        result = false;
+    }
+
+    // segments are renamed into place and indexed in order, so the index could be repaired from the last indexed one
+    std::unique_lock lock(write_mutex);
+    written.wait(lock, [&]() {
+        return next_written == segment.number;
+    });
+    if (result && write_failed) {
+        result = false;
+    }
+    if (result) {
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+        if (error) {
+            std::cerr << "Failed to rename <" << temporary_path.filename().string() << ">: " << error.message() << std::endl;
+            result = false;
+        }
+    }
+    if (result && !append_index(store, segment.number, names)) {
+        result = false;
+    }
+    write_failed = write_failed || !result;
+    ++next_written;
+    lock.unlock();
+    written.notify_all();
+
+    return result;
+}
+
+bool result_assimilator::run(const std::function<bool(std::filesystem::path&)>& next_result) {
+    std::mutex next_mutex;
+    std::atomic failed(false);
+
+    const auto& worker = [&]() {
+        try {
+            while (true) {
+                std::filesystem::path result;
+                {
+                    std::lock_guard lock(next_mutex);
+                    if (failed || !next_result(result)) {
+                        return;
+                    }
+                }
+
+                const auto& name = result.filename().string();
+                if (is_assimilated(name)) {
+                    continue;
+                }
+                std::vector<assimilated_ligand> ligands;
+                auto read = false;
+                try {
+                    read = read_result(result, ligands);
+                }
+                catch (const std::filesystem::filesystem_error& ex) {
+                    std::cerr << ex.what() << std::endl;
+                }
+                if (!read) {
+                    // broken results are skipped so they don't block the rest
+                    std::cerr << "Failed to assimilate <" << name << ">" << std::endl;
+                    continue;
+                }
+                if (!add(name, std::move(ligands))) {
+                    failed = true;
+                }
+            }
+        }
+        catch (const std::exception& ex) {
+            std::cerr << "Exception was thrown while assimilating results: " << ex.what() << std::endl;
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    return !failed && flush();
+}
+
+bool result_assimilator::read_result(const std::filesystem::path& result, std::vector<assimilated_ligand>& ligands) {
+    const zip_reader reader(result);
+    if (!reader.is_open()) {
+        return false;
+    }
+
+    const auto& workunit = result.stem().string();
+    const auto& add_poses = [&](const std::string& target, const std::string& name, const std::string& poses) {
+        assimilated_ligand ligand;
+        ligand.workunit = workunit;
+        ligand.target = target;
+        ligand.ligand = name;
+        if (read_best_pose(poses, ligand.affinity, ligand.pose)) {
+            ligands.emplace_back(std::move(ligand));
+        }
+    };
+
+    // outputs of several receptors or sites are listed with their target
+    std::map<std::string, std::string> targets;
+    if (reader.contains(results_targets::file)) {
+        std::string data;
+        if (!reader.read(results_targets::file, data) || !results_targets::read(data, targets)) {
+            return false;
+        }
+    }
+    const auto& target_of = [&targets](const std::string& entry) {
+        const auto& target = targets.find(entry);
+        return target == targets.end() ? std::string() : target->second;
+    };
+
+    const auto& entries_with = [&reader](const std::string& extension) {
+        std::vector<std::string> entries;
+        for (const auto& entry : reader.entries()) {
+            if (ends_with(entry, extension)) {
+                entries.push_back(entry);
+            }
+        }
+        return entries;
+    };
+
+    // batch streams with index, then separate PDBQT files, then binary results
+    std::vector<std::string> streams;
+    for (const auto& entry : entries_with(".idx")) {
+        streams.push_back(entry.substr(0, entry.size() - 4));
+    }
+    for (size_t i = 0; i < streams.size(); ++i) {
+        const auto& stream_name = streams[i];
+        const auto& entry = stream_name + ".idx";
+        std::string index;
+        std::string stream;
+        std::vector<stream_entry> stream_entries;
+        if (!reader.read(entry, index) || !reader.read(stream_name, stream) || !results_stream::read_index(index, stream_entries)) {
+            return false;
+        }
+        for (const auto& stream_entry : stream_entries) {
+            if (stream_entry.offset + stream_entry.size > stream.size()) {
+                std::cerr << "Wrong offset of <" << stream_entry.name << "> in <" << stream_name << ">" << std::endl;
+                return false;
+            }
+            add_poses(target_of(stream_name), stream_entry.name, stream.substr(stream_entry.offset, stream_entry.size));
+        }
+    }
+    if (!ligands.empty()) {
+        return true;
+    }
+
+    // separate files are named after the ligand or the target already
+    for (const auto& entry : entries_with(".pdbqt")) {
+        std::string poses;
+        if (!reader.read(entry, poses)) {
+            return false;
+        }
+        add_poses("", std::filesystem::path(entry).filename().string(), poses);
+    }
+    if (!ligands.empty()) {
+        return true;
+    }
+
+    const auto& binaries = entries_with(".bin");
+    for (size_t i = 0; i < binaries.size(); ++i) {
+        const auto& entry = binaries[i];
+        std::string data;
+        std::vector<ligand_result> results;
+        if (!reader.read(entry, data) || !results_file::read(data, results)) {
+            return false;
+        }
+        for (const auto& result_ligand : results) {
+            if (result_ligand.poses.empty() || result_ligand.poses.front().energies.empty()) {
+                continue;
+            }
+            const auto& best = result_ligand.poses.front();
+            assimilated_ligand ligand;
+            ligand.workunit = workunit;
+            ligand.target = target_of(entry);
+            ligand.ligand = result_ligand.name;
+            ligand.affinity = best.energies.front();
+            std::ostringstream pose;
+            pose << std::fixed << std::setprecision(3);
+            for (size_t i = 0; i + 2 < best.coordinates.size(); i += 3) {
+                pose << best.coordinates[i] << " " << best.coordinates[i + 1] << " " << best.coordinates[i + 2] << "\n";
+            }
+            ligand.pose = pose.str();
+            ligands.emplace_back(std::move(ligand));
+        }
+    }
+
+    return true;
+}
+
+bool result_assimilator::read_segment(const std::filesystem::path& segment, std::vector<assimilated_ligand>& ligands) {
+    const zip_reader reader(segment);
+    std::string workunit;
+    std::string target;
+    std::string ligand;
+    std::string affinity;
+    std::string pose;
+    std::string pose_offsets;
+    if (!reader.is_open() ||
+        !reader.read("workunit", workunit) ||
+        !reader.read("target", target) ||
+        !reader.read("ligand", ligand) ||
+        !reader.read("affinity", affinity) ||
+        !reader.read("pose", pose) ||
+        !reader.read("pose_offsets", pose_offsets)) {
+        std::cerr << "Failed to read <" << segment.filename().string() << ">" << std::endl;
+        return false;
+    }
+
+    const auto& workunits = split_lines(workunit);
+    const auto& targets = split_lines(target);
+    const auto& names = split_lines(ligand);
+    const auto rows = names.size();
+    if (workunits.size() != rows || targets.size() != rows || affinity.size() != rows * sizeof(float) || pose_offsets.size() != (rows + 1) * sizeof(uint64_t)) {
+        std::cerr << "Corrupted <" << segment.filename().string() << ">" << std::endl;
+        return false;
+    }
+
+    for (size_t row = 0; row < rows; ++row) {
+        const auto begin = get_uint64(pose_offsets.data() + row * sizeof(uint64_t));
+        const auto end = get_uint64(pose_offsets.data() + (row + 1) * sizeof(uint64_t));
+        if (begin > end || end > pose.size()) {
+            std::cerr << "Corrupted <" << segment.filename().string() << ">" << std::endl;
+            return false;
+        }
+        assimilated_ligand result;
+        result.workunit = workunits[row];
+        result.target = targets[row];
+        result.ligand = names[row];
+        result.affinity = get_float(affinity.data() + row * sizeof(float));
+        result.pose = pose.substr(begin, end - begin);
+        ligands.emplace_back(std::move(result));
+    }
+
+    return true;
+}
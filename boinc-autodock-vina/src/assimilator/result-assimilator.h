@@ -0,0 +1,89 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <string>
+#include <vector>
+
+class assimilated_ligand {
+public:
+    std::string workunit;
+    // receptor and site the ligand was docked against, empty for results of a single target
+    std::string target;
+    std::string ligand;
+    float affinity = .0f;
+    // best pose as PDBQT model, or "x y z" lines of heavy atoms for binary only results
+    std::string pose;
+};
+
+// Results store is a directory of segments, every segment is a ZIP archive with one entry per column:
+//   workunit, target, ligand - newline separated text
+//   affinity - float32 little-endian values
+//   pose, pose_offsets - concatenated best poses and uint64 little-endian offsets of every pose
+//   sources - result archives assimilated into the segment
+// ligands.idx has one "segment row ligand" line per stored ligand, followed by the target when it is set.
+// A segment is renamed into place only when complete, so assimilated results are tracked by the sources of the segments,
+// only hashes of their names are kept in memory.
+class result_assimilator final {
+public:
+    result_assimilator(const std::filesystem::path& store, const size_t& segment_rows, const int& threads);
+
+    // loads assimilated results and repairs the index after an interrupted run
+    [[nodiscard]] bool open();
+    [[nodiscard]] bool is_assimilated(const std::string& result) const;
+    [[nodiscard]] bool add(const std::string& result, std::vector<assimilated_ligand> ligands);
+    [[nodiscard]] bool flush();
+    // next_result returns false when there are no more results
+    [[nodiscard]] bool run(const std::function<bool(std::filesystem::path&)>& next_result);
+
+    [[nodiscard]] static bool read_result(const std::filesystem::path& result, std::vector<assimilated_ligand>& ligands);
+    [[nodiscard]] static bool read_segment(const std::filesystem::path& segment, std::vector<assimilated_ligand>& ligands);
+    [[nodiscard]] static std::filesystem::path segment_path(const std::filesystem::path& store, const uint64_t& segment);
+private:
+    class pending_segment final {
+    public:
+        uint64_t number = 0;
+        std::vector<assimilated_ligand> rows;
+        std::vector<std::string> sources;
+    };
+
+    // takes buffered rows under the lock, so they are compressed and written without it
+    void take_segment(pending_segment& segment);
+    [[nodiscard]] bool write_segment(pending_segment& segment);
+
+    std::filesystem::path store;
+    size_t segment_rows;
+    int threads;
+    uint64_t next_segment = 1;
+    // hashes of names of the assimilated results
+    std::unordered_set<uint64_t> assimilated;
+    std::vector<assimilated_ligand> rows;
+    std::vector<std::string> sources;
+    mutable std::mutex mutex;
+
+    std::mutex write_mutex;
+    std::condition_variable written;
+    uint64_t next_written = 1;
+    bool write_failed = false;
+};
@@ -17,15 +17,20 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <set>
 #include <thread>
 #include <atomic>
 #include <cmath>
+#include <algorithm>
 
 #include <boinc/boinc_api.h>
 #include <zip_helper/zip-extract.h>
-#include <zip_helper/zip-create.h>
+#include <zip_helper/zip-reader.h>
+#include <zip_helper/zip-writer.h>
 
 #include "calculate.h"
+#include "common/shared-files.h"
 
 #ifndef BOINC_AUTODOCK_VINA_VERSION
 #define BOINC_AUTODOCK_VINA_VERSION "unknown"
@@ -55,19 +60,19 @@ inline void report_progress(const double value) {
     }
 }
 
-bool unzip(const std::filesystem::path& zip, const std::filesystem::path& data_path) {
+bool unzip(const std::filesystem::path& zip, const std::filesystem::path& data_path, const std::vector<std::string>& entries, const int& threads) {
     char buf[256];
     if (!exists(zip) || !is_regular_file(zip)) {
         std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to open ZIP file." << std::endl;
         return false;
     }
 
-    if (!create_directories(data_path)) {
+    if (!exists(data_path) && !create_directories(data_path)) {
         std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to create working directory." << std::endl;
         return false;
     }
 
-    if (!zip_extract::extract(zip, data_path)) {
+    if (!zip_extract::extract(zip, data_path, entries, threads)) {
         std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to extract data from ZIP archive to working directory." << std::endl;
         return false;
     }
@@ -88,61 +93,161 @@ int perform_docking(const std::string& in_zip, const std::string& out_zip) noexc
             return res;
         }
 
-        constexpr int ncpus = 1;
+        APP_INIT_DATA aid;
+        boinc_get_init_data(aid);
+        const auto ncpus = std::max(1, static_cast<int>(aid.ncpus));
 
         std::atomic result(false);
 
         const auto& in_zip_path = std::filesystem::path(in_zip);
         const auto data_path = std::filesystem::current_path() / "data";
 
-        if (!unzip(in_zip_path, data_path)) {
-            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to extract data from ZIP archive to working directory, cannot proceed further" << std::endl;
+        const zip_reader input(in_zip_path);
+        if (!input.is_open()) {
+            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to open input ZIP archive, cannot proceed further" << std::endl;
             boinc_finish(1);
             return 1;
         }
 
-        std::filesystem::path json_path;
+        std::string json_entry;
         auto json_found = false;
-        for (const auto& file : std::filesystem::directory_iterator(data_path)) {
-            if (file.path().extension() == ".json") {
+        for (const auto& entry : input.entries()) {
+            const auto& path = std::filesystem::path(entry);
+            if (!path.has_parent_path() && path.extension() == ".json") {
                 if (json_found) {
-                    std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Working directory contains more than one configuration JSON file, cannot proceed further" << std::endl;
+                    std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Input archive contains more than one configuration JSON file, cannot proceed further" << std::endl;
                     boinc_finish(1);
                     return 1;
                 }
 
-                json_path = file.path();
+                json_entry = entry;
                 json_found = true;
             }
         }
 
         if (!json_found) {
-            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "No configuration JSON file found in working directory, cannot proceed further" << std::endl;
+            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "No configuration JSON file found in input archive, cannot proceed further" << std::endl;
+            boinc_finish(1);
+            return 1;
+        }
+
+        std::string json;
+        if (!input.read(json_entry, json)) {
+            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to read configuration JSON file from input archive, cannot proceed further" << std::endl;
             boinc_finish(1);
             return 1;
         }
 
         config conf;
 
-        if (!conf.load(json_path)) {
+        if (!conf.load(std::istringstream(json), data_path)) {
             std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Config load failed, cannot proceed further" << std::endl;
             boinc_finish(1);
             return 1;
         }
 
-        if (!conf.validate()) {
+        // ligands are read straight from the archive, only files Vina has to
+        // load from disk are extracted, in the order they are consumed
+        const auto& entry_name = [&data_path](const std::filesystem::path& file) {
+            return file.lexically_relative(data_path).generic_string();
+        };
+
+        std::set<std::string> in_memory{ json_entry };
+        for (const auto& ligand : conf.ligands) {
+            in_memory.insert(entry_name(ligand));
+        }
+        for (const auto& b : conf.batch) {
+            in_memory.insert(entry_name(b));
+        }
+
+        std::set<std::string> extracted;
+
+        // shared files are not in the archive, they are verified once per host and
+        // linked into the working directory under their logical names
+        if (!conf.shared.empty()) {
+            const auto& cache_file = aid.project_dir[0] != '\0' ? std::filesystem::path(aid.project_dir) / "boinc-autodock-vina-shared.txt" : std::filesystem::path();
+            for (const auto& [name, sha256] : conf.shared) {
+                std::string physical_name;
+                if (boinc_resolve_filename_s(name.c_str(), physical_name) ||
+                    !shared_files::verify(physical_name, sha256, cache_file) ||
+                    !shared_files::link(physical_name, data_path / name)) {
+                    std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to prepare shared file <" << name << ">, cannot proceed further" << std::endl;
+                    boinc_finish(1);
+                    return 1;
+                }
+                extracted.insert(name);
+            }
+        }
+
+        const auto& extract_referenced = [&](const std::vector<std::string>& files) {
+            std::vector<std::string> entries;
+            for (const auto& file : files) {
+                const auto& name = entry_name(file);
+                if (in_memory.count(name) == 0 && extracted.count(name) == 0 && input.contains(name)) {
+                    entries.emplace_back(name);
+                    extracted.insert(name);
+                }
+            }
+            return unzip(in_zip_path, data_path, entries, ncpus);
+        };
+
+        // the GPF has to be on disk first to find out which map files are used
+        if (!conf.maps.empty() && !extract_referenced({ conf.get_gpf_filename().string() })) {
+            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to extract maps GPF file from ZIP archive to working directory, cannot proceed further" << std::endl;
+            boinc_finish(1);
+            return 1;
+        }
+
+        if (!extract_referenced(conf.get_files())) {
+            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to extract data from ZIP archive to working directory, cannot proceed further" << std::endl;
+            boinc_finish(1);
+            return 1;
+        }
+
+        const auto& read_input = [&](const std::string& file, std::string& content) {
+            const auto& name = entry_name(file);
+            if (in_memory.count(name) != 0) {
+                return input.read(name, content);
+            }
+            return calculator::read_file(file, content);
+        };
+
+        const auto& file_exists = [&](const std::filesystem::path& file) {
+            const auto& name = entry_name(file);
+            if (in_memory.count(name) != 0) {
+                return input.contains(name);
+            }
+            return exists(file) && is_regular_file(file);
+        };
+
+        if (!conf.validate(file_exists)) {
             std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Config validation failed, cannot proceed further" << std::endl;
             boinc_finish(1);
             return 1;
         }
 
+        // poses are added to the output archive as soon as they are rendered and
+        // compressed in background while the next ligand is docked
+        zip_writer output(std::filesystem::path(out_zip), conf.compression, ncpus);
+        if (!output.is_open()) {
+            std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to create ZIP archive for results, cannot proceed further" << std::endl;
+            boinc_finish(1);
+            return 1;
+        }
+
+        const auto& write_output = [&output](const std::string& file, const std::string& content) {
+            return output.add(std::filesystem::path(file).filename().string(), content);
+        };
+
         boinc_fraction_done(0.);
 
-        std::thread worker([&result, &conf, &ncpus] {
+        // the CPUs assigned to the task are used for the archives, the search keeps a single CPU
+        constexpr int search_cpus = 1;
+        std::thread worker([&result, &conf, &search_cpus, &read_input, &write_output] {
             try {
-                result = calculator::calculate(conf, ncpus, [](const auto value) {
+                result = calculator::calculate(conf, search_cpus, [](const auto value) {
                     report_progress(value);
-                    });
+                    }, read_input, write_output);
             }
             catch (const std::exception& ex)
             {
@@ -160,14 +265,16 @@ int perform_docking(const std::string& in_zip, const std::string& out_zip) noexc
             return 1;
         }
 
-        const auto& out_zip_path = std::filesystem::path(out_zip);
-
-        std::vector<std::filesystem::path> out_files;
-        for (const auto& file : conf.get_out_files()) {
-            out_files.emplace_back(file);
+        // Vina writes maps to disk only
+        for (const auto& file : conf.get_write_maps_files()) {
+            if (!output.add_file(file)) {
+                std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to add maps to ZIP archive with results" << std::endl;
+                boinc_finish(1);
+                return 1;
+            }
         }
 
-        if (!zip_create::create(out_zip_path, out_files)) {
+        if (!output.close()) {
             std::cerr << boinc_msg_prefix(buf, sizeof(buf)) << "Failed to create ZIP archive with results" << std::endl;
             boinc_finish(1);
             return 1;
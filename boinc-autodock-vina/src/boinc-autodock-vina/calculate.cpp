@@ -17,20 +17,196 @@
 
 #include "calculate.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+
 #include <autodock-vina/vina.h>
 #include <magic_enum.hpp>
 
-bool calculator::calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback) {
-    constexpr int vina_verbosity = 1;
+#include "common/estimator.h"
+#include "common/interactions.h"
+#include "common/results.h"
+#include "common/summary.h"
+#include "common/top-k.h"
+#include "hash_helper/hash-helper.h"
+#include "search.h"
 
-    Vina vina(std::string(magic_enum::enum_name(config.scoring)), ncpus,
-        config.seed, vina_verbosity, config.no_refine,
-        const_cast<std::function<void(double)>*>(&progress_callback));
+inline bool write_poses(const std::string& out_name, const std::string& poses, const calculator::output_writer& write_output) {
+    if (poses.empty()) {
+        return true;
+    }
+    if (!write_output(out_name, poses)) {
+        std::cerr << "Failed to write poses to <" << std::filesystem::path(out_name).filename().string() << ">" << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    if (!config.receptor.empty() || !config.flex.empty()) {
-        vina.set_receptor(config.receptor, config.flex);
+// poses written for a ligand, sorted from the best energy, refinement replaces the best of them
+class written_poses {
+public:
+    // MODEL to ENDMDL records of every pose
+    std::vector<std::string> models;
+    // total energy first, then the energy terms
+    std::vector<std::vector<double>> energies;
+    // x, y, z of every ligand heavy atom
+    std::vector<std::vector<double>> coordinates;
+
+    [[nodiscard]] std::string pdbqt() const {
+        return std::accumulate(models.cbegin(), models.cend(), std::string());
+    }
+};
+
+inline written_poses get_written_poses(Vina& vina, const config& config) {
+    written_poses poses;
+    poses.energies = vina.get_poses_energies(config.get_out_poses(), config.energy_range);
+    poses.coordinates = vina.get_poses_coordinates(config.get_out_poses(), config.energy_range);
+
+    std::istringstream stream(vina.get_poses(config.get_out_poses(), config.energy_range));
+    std::string line;
+    std::string model;
+    while (std::getline(stream, line)) {
+        model += line + "\n";
+        if (line.compare(0, 6, "ENDMDL") == 0) {
+            poses.models.emplace_back(std::move(model));
+            model.clear();
+        }
+    }
+
+    const auto count = std::min({ poses.models.size(), poses.energies.size(), poses.coordinates.size() });
+    poses.models.resize(count);
+    poses.energies.resize(count);
+    poses.coordinates.resize(count);
+    return poses;
+}
+
+inline ligand_result collect_result(const written_poses& poses, const std::string& name, const std::vector<std::string>& inputs) {
+    ligand_result result;
+    result.name = name;
+    for (const auto& input : inputs) {
+        result.input_crc = hash_helper::crc32(result.input_crc, input.data(), input.size());
+    }
+
+    result.poses.resize(poses.energies.size());
+    for (size_t i = 0; i < result.poses.size(); ++i) {
+        result.poses[i].energies.assign(poses.energies[i].cbegin(), poses.energies[i].cend());
+        result.poses[i].coordinates.assign(poses.coordinates[i].cbegin(), poses.coordinates[i].cend());
+    }
+
+    return result;
+}
+
+inline ligand_summary summarize_ligand(Vina& vina, const std::vector<std::vector<double>>& energies, const std::string& name,
+    const search_budget& budget, const uint64_t& runs, const std::chrono::steady_clock::time_point& wall_start, const std::clock_t& cpu_start) {
+    ligand_summary summary;
+    summary.name = name;
+    summary.search_runs = runs;
+    summary.saved_runs = budget.exhaustiveness - static_cast<int64_t>(runs);
+    summary.exhaustiveness = budget.exhaustiveness;
+    summary.max_evals = budget.max_evals;
+    for (const auto& pose : energies) {
+        if (!pose.empty()) {
+            summary.affinities.push_back(pose.front());
+        }
+    }
+    summary.poses_found = vina.get_poses_energies(std::numeric_limits<int>::max(), std::numeric_limits<double>::max()).size();
+    summary.truncated = summary.poses_found > summary.affinities.size();
+    summary.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    summary.cpu_time = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    return summary;
+}
+
+inline bool analyze_ligand(const written_poses& poses, const std::vector<pdbqt_atom>& receptor, const std::string& name, ligand_interactions& result) {
+    std::vector<std::vector<pdbqt_atom>> models;
+    if (!interactions::read_models(poses.pdbqt(), models)) {
+        std::cerr << "Failed to read poses of <" << name << ">" << std::endl;
+        return false;
+    }
+
+    result.name = name;
+    for (size_t i = 0; i < std::min(models.size(), poses.energies.size()); ++i) {
+        result.poses.emplace_back(interactions::analyze(receptor, models[i], poses.energies[i].empty() ? .0 : poses.energies[i].front()));
+    }
+    return true;
+}
+
+inline bool is_dropped(const written_poses& poses, const config& config) {
+    if (!config.affinity_threshold.has_value()) {
+        return false;
+    }
+    return poses.energies.empty() || poses.energies.front().empty() || poses.energies.front().front() > config.affinity_threshold.value();
+}
+
+// returns the number of MC runs performed, with early_stop the search is repeated in rounds of growing exhaustiveness until
+// the best poses are stable, a round keeps the runs of the previous one, so the poses of the last round are the best found
+inline uint64_t search_ligand(Vina& vina, const config& config, const search_budget& budget) {
+    if (!config.early_stop) {
+        vina.global_search(budget.exhaustiveness, config.num_modes, config.min_rmsd, budget.max_evals);
+        return static_cast<uint64_t>(budget.exhaustiveness);
+    }
+
+    const auto poses = static_cast<int>(std::min(config.early_stop_poses, config.num_modes));
+    std::vector<std::vector<double>> energies;
+    std::vector<std::vector<double>> coordinates;
+    uint64_t runs = 0;
+    int64_t stable_rounds = 0;
+    for (const auto& exhaustiveness : early_stop::rounds(budget.exhaustiveness)) {
+        vina.global_search(static_cast<int>(exhaustiveness), config.num_modes, config.min_rmsd, budget.max_evals);
+        runs += static_cast<uint64_t>(exhaustiveness);
+
+        auto round_energies = vina.get_poses_energies(poses, std::numeric_limits<double>::max());
+        auto round_coordinates = vina.get_poses_coordinates(poses, std::numeric_limits<double>::max());
+        stable_rounds = early_stop::is_stable(energies, coordinates, round_energies, round_coordinates, config) ? stable_rounds + 1 : 0;
+        if (stable_rounds >= config.early_stop_rounds) {
+            break;
+        }
+
+        energies = std::move(round_energies);
+        coordinates = std::move(round_coordinates);
+    }
+    return runs;
+}
+
+// every MODEL of a multi-model PDBQT file is a pose, a file without MODEL records is a single pose
+inline std::vector<std::string> split_models(const std::string& pdbqt) {
+    std::vector<std::string> models;
+    std::istringstream stream(pdbqt);
+    std::string line;
+    std::string model;
+    auto in_model = false;
+    while (std::getline(stream, line)) {
+        if (line.compare(0, 5, "MODEL") == 0) {
+            in_model = true;
+            model.clear();
+        }
+        else if (line.compare(0, 6, "ENDMDL") == 0) {
+            in_model = false;
+            models.emplace_back(std::move(model));
+            model.clear();
+        }
+        else {
+            model += line + "\n";
+        }
+    }
+    if (models.empty() && !in_model && !model.empty()) {
+        models.emplace_back(std::move(model));
     }
+    return models;
+}
 
+inline void set_weights(Vina& vina, const config& config) {
     if (config.scoring == scoring::vina) {
         vina.set_vina_weights(config.weight_gauss1, config.weight_gauss2,
             config.weight_repulsion, config.weight_hydrophobic, config.weight_hydrogen,
@@ -41,6 +217,394 @@ bool calculator::calculate(const config& config, const int& ncpus, const std::fu
             config.weight_hydrophobic, config.weight_hydrogen,
             config.weight_glue, config.weight_rot);
     }
+}
+
+// the best poses are optimized again against explicit receptor atoms, the rest keep grid based energies,
+// then poses are sorted by their new energies
+inline bool refine_poses(Vina& refiner, const config& config, written_poses& poses) {
+    // Vina writes the optimized pose only to a file, named after the output of the
+    // target as sites of one receptor are docked in parallel in the same directory
+    const auto& out = std::filesystem::path(config.out.empty() ? config.batch_out : config.out);
+    const auto& pose_file = out.parent_path() / (out.stem().string() + ".refine.pdbqt.tmp");
+    const std::string result_remark = "REMARK VINA RESULT:";
+
+    const auto refined = std::min(poses.models.size(), static_cast<size_t>(config.refine_top_k));
+    for (size_t i = 0; i < refined; ++i) {
+        std::string ligand;
+        double lower_rmsd = .0;
+        double upper_rmsd = .0;
+        std::istringstream stream(poses.models[i]);
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (line.compare(0, result_remark.size(), result_remark) == 0) {
+                double affinity;
+                std::istringstream(line.substr(result_remark.size())) >> affinity >> lower_rmsd >> upper_rmsd;
+            }
+            else if (line.compare(0, 5, "MODEL") != 0 && line.compare(0, 6, "ENDMDL") != 0) {
+                ligand += line + "\n";
+            }
+        }
+
+        refiner.set_ligand_from_string(ligand);
+        const auto& energies = refiner.optimize();
+        refiner.write_pose(pose_file.string());
+        std::string refined_pose;
+        const auto read = calculator::read_file(pose_file.string(), refined_pose);
+        std::filesystem::remove(pose_file);
+        if (!read || energies.empty()) {
+            return false;
+        }
+
+        std::ostringstream model;
+        model << poses.models[i].substr(0, poses.models[i].find('\n') + 1);
+        model << result_remark << std::fixed << std::setprecision(3) << std::setw(10) << energies.front();
+        model << std::setw(11) << lower_rmsd << std::setw(11) << upper_rmsd << "\n";
+        std::istringstream refined_stream(refined_pose);
+        while (std::getline(refined_stream, line)) {
+            if (line.compare(0, result_remark.size(), result_remark) != 0 && line.compare(0, 5, "MODEL") != 0 && line.compare(0, 6, "ENDMDL") != 0) {
+                model << line << "\n";
+            }
+        }
+        model << "ENDMDL\n";
+        poses.models[i] = model.str();
+        poses.energies[i] = energies;
+    }
+
+    std::vector<size_t> order(poses.models.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&poses](const auto& a, const auto& b) {
+        return poses.energies[a].front() < poses.energies[b].front();
+    });
+    written_poses sorted;
+    for (const auto& i : order) {
+        const auto& model = poses.models[i];
+        sorted.models.emplace_back("MODEL " + std::to_string(sorted.models.size() + 1) + model.substr(model.find('\n')));
+        sorted.energies.emplace_back(std::move(poses.energies[i]));
+    }
+
+    // coordinates of all poses are read from PDBQT, so refined and other poses list heavy atoms in the same order
+    std::vector<std::vector<pdbqt_atom>> models;
+    if (!interactions::read_models(sorted.pdbqt(), models)) {
+        return false;
+    }
+    for (const auto& model : models) {
+        auto& coordinates = sorted.coordinates.emplace_back();
+        for (const auto& atom : model) {
+            if (!interactions::is_hydrogen(atom.type)) {
+                coordinates.insert(coordinates.end(), { atom.x, atom.y, atom.z });
+            }
+        }
+    }
+
+    poses = std::move(sorted);
+    return true;
+}
+
+class rescorer {
+public:
+    std::string name;
+    std::unique_ptr<Vina> vina;
+};
+
+// every model gets "REMARK RESCORE function: energy" lines after its Vina result
+inline std::string rescore_poses(const std::string& poses, const std::vector<rescorer>& rescorers) {
+    std::ostringstream result;
+    std::istringstream stream(poses);
+    std::string line;
+    std::vector<std::string> model;
+    while (std::getline(stream, line)) {
+        model.push_back(line);
+        if (line.compare(0, 6, "ENDMDL") != 0) {
+            continue;
+        }
+
+        std::string ligand;
+        for (const auto& l : model) {
+            if (l.compare(0, 5, "MODEL") != 0 && l.compare(0, 6, "ENDMDL") != 0) {
+                ligand += l + "\n";
+            }
+        }
+        std::ostringstream remarks;
+        remarks << std::fixed << std::setprecision(3);
+        for (const auto& r : rescorers) {
+            r.vina->set_ligand_from_string(ligand);
+            const auto& energies = r.vina->score();
+            remarks << "REMARK RESCORE " << r.name << ": " << std::setw(10) << (energies.empty() ? .0 : energies.front()) << "\n";
+        }
+
+        const auto& result_line = std::find_if(model.cbegin(), model.cend(), [](const auto& l) { return l.compare(0, 18, "REMARK VINA RESULT") == 0; });
+        const auto& insert_after = result_line == model.cend() ? model.cbegin() : result_line;
+        for (auto it = model.cbegin(); it != model.cend(); ++it) {
+            result << *it << "\n";
+            if (it == insert_after) {
+                result << remarks.str();
+            }
+        }
+        model.clear();
+    }
+    for (const auto& l : model) {
+        result << l << "\n";
+    }
+    return result.str();
+}
+
+bool calculator::read_file(const std::string& file, std::string& content) {
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+
+    stream.seekg(0, std::ios::end);
+    content.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0, std::ios::beg);
+    return static_cast<bool>(stream.read(content.data(), static_cast<std::streamsize>(content.size())));
+}
+
+bool calculator::write_file(const std::string& file, const std::string& content) {
+    const auto& parent = std::filesystem::path(file).parent_path();
+    if (!parent.empty() && !exists(parent)) {
+        create_directories(parent);
+    }
+
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+    return static_cast<bool>(stream.write(content.data(), static_cast<std::streamsize>(content.size())));
+}
+
+bool calculator::calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback) {
+    return calculate(config, ncpus, progress_callback, read_file, write_file);
+}
+
+bool calculator::calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback, const input_reader& read_input) {
+    return calculate(config, ncpus, progress_callback, read_input, write_file);
+}
+
+bool calculator::calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback, const input_reader& read_input, const output_writer& write_output) {
+    if (config.receptors.empty() && config.sites.empty()) {
+        workunit_summary summary;
+        return dock(config, ncpus, progress_callback, read_input, write_output, summary);
+    }
+
+    const auto& targets = config.get_targets();
+    std::vector<std::string> names;
+    for (const auto& [name, target] : targets) {
+        names.push_back(name);
+    }
+    std::vector<workunit_summary> summaries(targets.size());
+    std::vector<double> progress(targets.size(), .0);
+
+    // input, output and progress are shared by the sites docked in parallel
+    std::mutex shared_mutex;
+    const input_reader& read_shared = [&](const std::string& file, std::string& content) {
+        std::lock_guard lock(shared_mutex);
+        return read_input(file, content);
+    };
+    // every output is listed with its target, so results don't have to be told apart by file names
+    results_targets outputs;
+
+    // receptor-major order: maps of a receptor are computed once per site and released after all ligands are docked against it,
+    // sites of the same receptor are docked in parallel with threads split between them
+    const auto threads = ncpus > 0 ? ncpus : static_cast<int>(std::thread::hardware_concurrency());
+    const auto sites = std::max<size_t>(1, config.sites.size());
+    const auto parallel = std::max<size_t>(1, std::min(sites, static_cast<size_t>(threads)));
+    const auto site_cpus = parallel == 1 ? ncpus : std::max(1, threads / static_cast<int>(parallel));
+    for (size_t first = 0; first < targets.size(); first += sites) {
+        std::atomic next(first);
+        std::atomic failed(false);
+        const auto& worker = [&]() {
+            for (auto i = next++; i < first + sites && !failed; i = next++) {
+                const std::function<void(double)> target_progress = [&, i](double value) {
+                    std::lock_guard lock(shared_mutex);
+                    progress[i] = value;
+                    progress_callback(std::accumulate(progress.cbegin(), progress.cend(), .0) / static_cast<double>(progress.size()));
+                };
+                const output_writer& write_target = [&, i](const std::string& file, const std::string& content) {
+                    std::lock_guard lock(shared_mutex);
+                    outputs.add(std::filesystem::path(file).filename().string(), targets[i].first);
+                    return write_output(file, content);
+                };
+                try {
+                    if (!dock(targets[i].second, site_cpus, target_progress, read_shared, write_target, summaries[i])) {
+                        failed = true;
+                    }
+                }
+                catch (const std::exception& ex) {
+                    std::cerr << "Docking to <" << targets[i].first << "> failed: " << ex.what() << std::endl;
+                    failed = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < parallel; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& w : workers) {
+            w.join();
+        }
+        if (failed) {
+            return false;
+        }
+    }
+
+    std::string data;
+    if (!summary_file::write_ensemble(names, summaries, data) || !write_output(config.ensemble, data)) {
+        std::cerr << "Failed to write ensemble scores to <" << std::filesystem::path(config.ensemble).filename().string() << ">" << std::endl;
+        return false;
+    }
+    if (!write_output((std::filesystem::path(config.ensemble).parent_path() / results_targets::file).string(), outputs.data())) {
+        std::cerr << "Failed to write targets of results to <" << results_targets::file << ">" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool calculator::dock(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback, const input_reader& read_input, const output_writer& write_output, workunit_summary& summary) {
+    constexpr int vina_verbosity = 1;
+
+    const auto& wall_start = std::chrono::steady_clock::now();
+    const auto cpu_start = std::clock();
+
+    const auto write_pdbqt = config.output_format != result_format::binary;
+    const auto write_binary = config.output_format != result_format::pdbqt;
+    std::vector<ligand_result> results;
+    results_stream stream;
+    top_k_ligands top(static_cast<size_t>(config.top_k));
+    std::vector<pdbqt_atom> receptor_atoms;
+    std::vector<ligand_interactions> ligands_interactions;
+
+    // with refine_top_k the search doesn't refine poses, the best ones are refined separately
+    Vina vina(std::string(magic_enum::enum_name(config.scoring)), ncpus,
+        config.seed, vina_verbosity, config.no_refine || config.refine_top_k > 0,
+        const_cast<std::function<void(double)>*>(&progress_callback));
+
+    // additional scoring functions and the refiner share the receptor file, their maps are computed for the box
+    std::function<void(double)> rescoring_progress = [](double) {};
+    std::vector<rescorer> rescorers;
+    for (const auto& function : config.rescoring) {
+        const auto& name = std::string(magic_enum::enum_name(function));
+        rescorers.push_back({ name, std::make_unique<Vina>(name, ncpus, config.seed, vina_verbosity, config.no_refine, &rescoring_progress) });
+        rescorers.back().vina->set_receptor(config.receptor);
+    }
+    std::unique_ptr<Vina> refiner;
+    if (config.refine_top_k > 0) {
+        refiner = std::make_unique<Vina>(std::string(magic_enum::enum_name(config.scoring)), ncpus, config.seed, vina_verbosity, false, &rescoring_progress);
+        refiner->set_receptor(config.receptor);
+        set_weights(*refiner, config);
+    }
+    const auto& compute_extra_maps = [&](const std::string& ligand) {
+        std::vector<Vina*> instances;
+        for (auto& r : rescorers) {
+            instances.push_back(r.vina.get());
+        }
+        if (refiner) {
+            instances.push_back(refiner.get());
+        }
+        for (auto* instance : instances) {
+            // with a ligand only maps of its atom types are computed
+            if (!ligand.empty()) {
+                instance->set_ligand_from_string(ligand);
+            }
+            instance->compute_vina_maps(config.center_x, config.center_y,
+                config.center_z, config.size_x, config.size_y,
+                config.size_z, config.spacing,
+                config.force_even_voxels);
+        }
+    };
+
+    const auto& write_ranked = [&](ranked_ligand& ligand) {
+        if (write_pdbqt && !config.batch_out.empty()) {
+            stream.add(ligand.name, ligand.poses);
+        }
+        else if (write_pdbqt && !write_poses(ligand.out_name, ligand.poses, write_output)) {
+            return false;
+        }
+        if (write_binary) {
+            results.emplace_back(std::move(ligand.result));
+        }
+        if (!config.interactions.empty()) {
+            ligands_interactions.emplace_back(std::move(ligand.interactions));
+        }
+        return true;
+    };
+
+    // dropped ligands have no poses written and keep only the best affinity in the summary
+    const auto& drop = [&](const size_t& order) {
+        if (order < summary.ligands.size()) {
+            auto& ligand_summary = summary.ligands[order];
+            ligand_summary.dropped = true;
+            ligand_summary.affinities.resize(std::min<size_t>(1, ligand_summary.affinities.size()));
+        }
+    };
+
+    const auto& write_ligand = [&](const std::string& name, const std::string& out_name, const std::vector<std::string>& inputs,
+        const search_budget& budget, const uint64_t& runs,
+        const std::chrono::steady_clock::time_point& ligand_wall_start, const std::clock_t& ligand_cpu_start) {
+        // refined energies rank the poses and the ligand everywhere, in the summary as well
+        auto poses = get_written_poses(vina, config);
+        if (refiner && !refine_poses(*refiner, config, poses)) {
+            std::cerr << "Failed to refine poses of <" << name << ">" << std::endl;
+            return false;
+        }
+
+        // summary is also kept without summary file for the ensemble scores
+        const auto order = summary.ligands.size();
+        summary.ligands.emplace_back(summarize_ligand(vina, poses.energies, name, budget, runs, ligand_wall_start, ligand_cpu_start));
+
+        // ligands above the affinity threshold are only listed in the summary
+        if (is_dropped(poses, config)) {
+            drop(order);
+            return true;
+        }
+
+        ranked_ligand ligand;
+        ligand.name = name;
+        ligand.order = order;
+        ligand.out_name = out_name;
+        if (!config.interactions.empty() && !analyze_ligand(poses, receptor_atoms, name, ligand.interactions)) {
+            return false;
+        }
+        if (write_pdbqt) {
+            ligand.poses = rescorers.empty() ? poses.pdbqt() : rescore_poses(poses.pdbqt(), rescorers);
+        }
+        if (write_binary) {
+            ligand.result = collect_result(poses, name, inputs);
+        }
+
+        if (config.top_k == 0) {
+            return write_ranked(ligand);
+        }
+
+        if (poses.energies.empty() || poses.energies.front().empty()) {
+            drop(order);
+            return true;
+        }
+        ligand.affinity = poses.energies.front().front();
+        if (const auto& rejected = top.add(std::move(ligand)); rejected.has_value()) {
+            drop(rejected->order);
+        }
+        return true;
+    };
+
+    if (!config.receptor.empty() || !config.flex.empty()) {
+        vina.set_receptor(config.receptor, config.flex);
+    }
+
+    if (!config.interactions.empty()) {
+        std::string content;
+        if (!read_input(config.receptor, content) || !interactions::read_atoms(content, receptor_atoms)) {
+            std::cerr << "Failed to read receptor <" << std::filesystem::path(config.receptor).filename().string() << ">" << std::endl;
+            return false;
+        }
+    }
+
+    if (config.scoring == scoring::vina || config.scoring == scoring::vinardo) {
+        set_weights(vina, config);
+    }
     else if (config.scoring == scoring::ad4) {
         vina.set_ad4_weights(config.weight_ad4_vdw, config.weight_ad4_hb,
             config.weight_ad4_elec, config.weight_ad4_dsolv, config.weight_glue,
@@ -52,8 +616,65 @@ bool calculator::calculate(const config& config, const int& ncpus, const std::fu
         }
     }
 
-    if (!config.ligands.empty()) {
-        vina.set_ligand_from_file(config.ligands);
+    if (config.mode != docking_mode::dock) {
+        if (config.scoring == scoring::vina || config.scoring == scoring::vinardo) {
+            if (!config.maps.empty()) {
+                vina.load_maps(config.maps);
+            }
+            else {
+                vina.compute_vina_maps(config.center_x, config.center_y,
+                    config.center_z, config.size_x, config.size_y,
+                    config.size_z, config.spacing,
+                    config.force_even_voxels);
+
+                if (!config.write_maps.empty())
+                    vina.write_maps(config.write_maps);
+            }
+        }
+
+        std::vector<pose_score> scores;
+        for (const auto& files : { config.ligands, config.batch }) {
+            for (const auto& file : files) {
+                std::string content;
+                if (!read_input(file, content)) {
+                    std::cerr << "Failed to read ligand <" << std::filesystem::path(file).filename().string() << ">" << std::endl;
+                    return false;
+                }
+
+                const auto& name = std::filesystem::path(file).filename().string();
+                const auto& models = split_models(content);
+                for (size_t i = 0; i < models.size(); ++i) {
+                    // a pose Vina can't score (e.g. outside of the box) gets no energy instead of failing the whole set
+                    pose_score score{ name, i + 1, {} };
+                    try {
+                        vina.set_ligand_from_string(models[i]);
+                        score.energies = config.mode == docking_mode::score_only ? vina.score() : vina.optimize();
+                    }
+                    catch (const std::exception& ex) {
+                        std::cerr << "Failed to score pose " << i + 1 << " of <" << name << ">: " << ex.what() << std::endl;
+                    }
+                    scores.push_back(std::move(score));
+                }
+            }
+        }
+
+        std::string data;
+        if (!summary_file::write_scores(scores, data) || !write_output(config.scores, data)) {
+            std::cerr << "Failed to write scores to <" << std::filesystem::path(config.scores).filename().string() << ">" << std::endl;
+            return false;
+        }
+    }
+    else if (!config.ligands.empty()) {
+        std::vector<std::string> ligands;
+        for (const auto& ligand : config.ligands) {
+            std::string content;
+            if (!read_input(ligand, content)) {
+                std::cerr << "Failed to read ligand <" << std::filesystem::path(ligand).filename().string() << ">" << std::endl;
+                return false;
+            }
+            ligands.emplace_back(std::move(content));
+        }
+        vina.set_ligand_from_string(ligands);
 
         if (config.scoring == scoring::vina || config.scoring == scoring::vinardo) {
             if (!config.maps.empty()) {
@@ -70,9 +691,21 @@ bool calculator::calculate(const config& config, const int& ncpus, const std::fu
             }
         }
 
-        vina.global_search(config.exhaustiveness, config.num_modes, config.min_rmsd,
-            config.max_evals);
-        vina.write_poses(config.out, config.num_modes, config.energy_range);
+        compute_extra_maps(ligands.front());
+
+        std::string name;
+        for (const auto& ligand : config.ligands) {
+            name += (name.empty() ? "" : ";") + std::filesystem::path(ligand).filename().string();
+        }
+
+        const auto& ligand_wall_start = std::chrono::steady_clock::now();
+        const auto ligand_cpu_start = std::clock();
+
+        const search_budget budget{ config.exhaustiveness, config.max_evals };
+        const auto runs = search_ligand(vina, config, budget);
+        if (!write_ligand(name, config.out, ligands, budget, runs, ligand_wall_start, ligand_cpu_start)) {
+            return false;
+        }
     }
     else if (!config.batch.empty()) {
         if (config.scoring == scoring::vina) {
@@ -89,14 +722,114 @@ bool calculator::calculate(const config& config, const int& ncpus, const std::fu
             }
         }
 
-        for (const auto& b : config.batch) {
-            vina.set_ligand_from_file(b);
+        compute_extra_maps({});
+
+        std::vector<search_budget> budgets(config.batch.size(), { config.exhaustiveness, config.max_evals });
+        if (config.adaptive_search) {
+            std::vector<ligand_features> features(config.batch.size());
+            for (size_t i = 0; i < config.batch.size(); ++i) {
+                std::string ligand;
+                if (!read_input(config.batch[i], ligand) || !estimator::read_ligand(ligand, features[i])) {
+                    std::cerr << "Failed to read ligand <" << std::filesystem::path(config.batch[i]).filename().string() << ">" << std::endl;
+                    return false;
+                }
+            }
+            budgets = estimator::allocate_search(config, features);
+        }
+
+        // first funnel stage docks every ligand with low exhaustiveness on the same maps
+        std::vector<ligand_summary> screened;
+        std::vector<bool> selected;
+        if (config.funnel_exhaustiveness > 0) {
+            for (size_t i = 0; i < config.batch.size(); ++i) {
+                const auto& b = config.batch[i];
+                std::string ligand;
+                if (!read_input(b, ligand)) {
+                    std::cerr << "Failed to read ligand <" << std::filesystem::path(b).filename().string() << ">" << std::endl;
+                    return false;
+                }
+                vina.set_ligand_from_string(ligand);
+
+                const auto& ligand_wall_start = std::chrono::steady_clock::now();
+                const auto ligand_cpu_start = std::clock();
+
+                // ligands not selected for the second stage have no runs of their search budget performed
+                vina.global_search(config.funnel_exhaustiveness, config.num_modes, config.min_rmsd, budgets[i].max_evals);
+                screened.emplace_back(summarize_ligand(vina, vina.get_poses_energies(config.get_out_poses(), config.energy_range),
+                    std::filesystem::path(b).filename().string(), budgets[i], 0, ligand_wall_start, ligand_cpu_start));
+                screened.back().funnel_runs = static_cast<uint64_t>(config.funnel_exhaustiveness);
+            }
+            selected = funnel::select(config, screened);
+        }
+
+        for (size_t i = 0; i < config.batch.size(); ++i) {
+            const auto& b = config.batch[i];
+            if (!selected.empty() && !selected[i]) {
+                const auto order = summary.ligands.size();
+                summary.ligands.emplace_back(std::move(screened[i]));
+                drop(order);
+                continue;
+            }
+
+            std::string ligand;
+            if (!read_input(b, ligand)) {
+                std::cerr << "Failed to read ligand <" << std::filesystem::path(b).filename().string() << ">" << std::endl;
+                return false;
+            }
+            vina.set_ligand_from_string(ligand);
+
+            const auto& name = std::filesystem::path(b).filename().string();
+            const auto& out_name = (std::filesystem::path(config.dir) / name).string();
+
+            const auto& ligand_wall_start = std::chrono::steady_clock::now();
+            const auto ligand_cpu_start = std::clock();
+
+            const auto order = summary.ligands.size();
+            const auto runs = search_ligand(vina, config, budgets[i]);
+            if (!write_ligand(name, out_name, { ligand }, budgets[i], runs, ligand_wall_start, ligand_cpu_start)) {
+                return false;
+            }
+            summary.ligands[order].funnel_runs = static_cast<uint64_t>(config.funnel_exhaustiveness);
+        }
+    }
+
+    for (auto& ligand : top.take()) {
+        if (!write_ranked(ligand)) {
+            return false;
+        }
+    }
+
+    if (write_pdbqt && !config.batch_out.empty()) {
+        if (!write_output(config.batch_out, stream.data()) || !write_output(config.get_batch_out_index(), stream.index())) {
+            std::cerr << "Failed to write batch results to <" << std::filesystem::path(config.batch_out).filename().string() << ">" << std::endl;
+            return false;
+        }
+    }
+
+    if (write_binary) {
+        std::string data;
+        if (!results_file::write(results, data) || !write_output(config.get_binary_out(), data)) {
+            std::cerr << "Failed to write results to <" << std::filesystem::path(config.get_binary_out()).filename().string() << ">" << std::endl;
+            return false;
+        }
+    }
+
+    if (!config.interactions.empty()) {
+        std::string data;
+        if (!interactions::write(ligands_interactions, data) || !write_output(config.interactions, data)) {
+            std::cerr << "Failed to write interactions to <" << std::filesystem::path(config.interactions).filename().string() << ">" << std::endl;
+            return false;
+        }
+    }
 
-            const auto& out_name = (std::filesystem::path(config.dir) / b).string();
+    if (!config.summary.empty()) {
+        summary.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+        summary.cpu_time = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
 
-            vina.global_search(config.exhaustiveness, config.num_modes, config.min_rmsd,
-                config.max_evals);
-            vina.write_poses(out_name, config.num_modes, config.energy_range);
+        std::string data;
+        if (!summary_file::write(config.summary, summary, data) || !write_output(config.summary, data)) {
+            std::cerr << "Failed to write summary to <" << std::filesystem::path(config.summary).filename().string() << ">" << std::endl;
+            return false;
         }
     }
 
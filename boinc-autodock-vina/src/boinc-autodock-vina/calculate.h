@@ -19,10 +19,23 @@
 
 #include <filesystem>
 #include <functional>
+#include <string>
 
 #include "common/config.h"
+#include "common/summary.h"
 
 class calculator {
 public:
+    using input_reader = std::function<bool(const std::string& file, std::string& content)>;
+    using output_writer = std::function<bool(const std::string& file, const std::string& content)>;
+
     [[nodiscard]] static bool calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback);
+    [[nodiscard]] static bool calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback, const input_reader& read_input);
+    [[nodiscard]] static bool calculate(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback, const input_reader& read_input, const output_writer& write_output);
+    [[nodiscard]] static bool read_file(const std::string& file, std::string& content);
+    [[nodiscard]] static bool write_file(const std::string& file, const std::string& content);
+
+private:
+    // docking against a single receptor, summary is filled for every ligand
+    [[nodiscard]] static bool dock(const config& config, const int& ncpus, const std::function<void(double)>& progress_callback, const input_reader& read_input, const output_writer& write_output, workunit_summary& summary);
 };
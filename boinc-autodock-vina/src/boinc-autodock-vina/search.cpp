@@ -0,0 +1,81 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+
+#include "search.h"
+
+std::vector<int64_t> early_stop::rounds(const int64_t& exhaustiveness) {
+    std::vector<int64_t> result;
+    if (exhaustiveness <= 0) {
+        return result;
+    }
+    // checks before the full search take at most half of its runs together
+    for (auto round = std::max<int64_t>(1, exhaustiveness / 8); round * 2 <= exhaustiveness; round *= 2) {
+        result.push_back(round);
+    }
+    result.push_back(exhaustiveness);
+    return result;
+}
+
+bool early_stop::is_stable(const std::vector<std::vector<double>>& previous_energies, const std::vector<std::vector<double>>& previous_coordinates,
+    const std::vector<std::vector<double>>& energies, const std::vector<std::vector<double>>& coordinates, const config& config) {
+    if (energies.empty() || energies.size() != previous_energies.size() || coordinates.size() != previous_coordinates.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < energies.size(); ++i) {
+        if (energies[i].empty() || previous_energies[i].empty() ||
+            std::fabs(energies[i].front() - previous_energies[i].front()) > config.early_stop_energy) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < coordinates.size(); ++i) {
+        if (coordinates[i].size() != previous_coordinates[i].size()) {
+            return false;
+        }
+        double sum = .0;
+        for (size_t j = 0; j < coordinates[i].size(); ++j) {
+            sum += (coordinates[i][j] - previous_coordinates[i][j]) * (coordinates[i][j] - previous_coordinates[i][j]);
+        }
+        const auto atoms = coordinates[i].size() / 3;
+        if (atoms > 0 && std::sqrt(sum / static_cast<double>(atoms)) > config.early_stop_rmsd) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<bool> funnel::select(const config& config, const std::vector<ligand_summary>& screened) {
+    std::vector<size_t> ranked;
+    for (size_t i = 0; i < screened.size(); ++i) {
+        if (!screened[i].affinities.empty()) {
+            ranked.push_back(i);
+        }
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [&](const auto& a, const auto& b) {
+        return screened[a].affinities.front() < screened[b].affinities.front();
+    });
+
+    std::vector<bool> selected(screened.size(), false);
+    const auto top = static_cast<size_t>(std::ceil(static_cast<double>(screened.size()) * config.funnel_top_percent / 100.0));
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        const auto affinity = screened[ranked[i]].affinities.front();
+        selected[ranked[i]] = i < top || (config.funnel_energy_cutoff.has_value() && affinity <= config.funnel_energy_cutoff.value());
+    }
+    return selected;
+}
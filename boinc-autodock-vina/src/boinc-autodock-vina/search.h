@@ -0,0 +1,40 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/summary.h"
+
+class early_stop final {
+public:
+    // exhaustiveness of every search round, rounds double up to half of the budget and the last one is the full budget. Vina seeds every search the same way,
+    // so a round repeats the MC runs of the one before it and the last round is the same as a single full search
+    [[nodiscard]] static std::vector<int64_t> rounds(const int64_t& exhaustiveness);
+    // best poses of two search rounds are the same when every pose kept its energy and position
+    [[nodiscard]] static bool is_stable(const std::vector<std::vector<double>>& previous_energies, const std::vector<std::vector<double>>& previous_coordinates,
+        const std::vector<std::vector<double>>& energies, const std::vector<std::vector<double>>& coordinates, const config& config);
+};
+
+class funnel final {
+public:
+    // ligands of the first funnel stage in the top percent or at or below the energy cutoff are docked again
+    [[nodiscard]] static std::vector<bool> select(const config& config, const std::vector<ligand_summary>& screened);
+};
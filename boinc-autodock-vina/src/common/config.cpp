@@ -15,8 +15,11 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <fstream>
+#include <set>
 #include <sstream>
 
 #include <magic_enum.hpp>
@@ -25,7 +28,15 @@
 
 #include "config.h"
 
+inline bool file_exists_on_disk(const std::filesystem::path& file) {
+    return std::filesystem::exists(file) && std::filesystem::is_regular_file(file);
+}
+
 bool config::validate() const {
+    return validate(file_exists_on_disk);
+}
+
+bool config::validate(const std::function<bool(const std::filesystem::path&)>& file_exists) const {
     if (!receptor.empty() && !maps.empty()) {
         std::cerr << "Cannot specify both receptor and maps at the same time,";
         std::cerr << "flex parameter is allowed with receptor or maps";
@@ -33,15 +44,21 @@ bool config::validate() const {
         return false;
     }
 
+    if (!receptors.empty() && (!receptor.empty() || !maps.empty() || !flex.empty())) {
+        std::cerr << "Receptors ensemble cannot be combined with receptor, maps or flex";
+        std::cerr << std::endl;
+        return false;
+    }
+
     if (scoring == scoring::vina || scoring == scoring::vinardo) {
-        if (receptor.empty() && maps.empty()) {
+        if (receptor.empty() && receptors.empty() && maps.empty()) {
             std::cerr << "The receptor or maps must be specified.";
             std::cerr << std::endl;
             return false;
         }
     }
     else if (scoring == scoring::ad4) {
-        if (!receptor.empty()) {
+        if (!receptor.empty() || !receptors.empty()) {
             std::cerr << "No receptor allowed, only flex parameter with the AD4 scoring function.";
             std::cerr << std::endl;
             return false;
@@ -70,8 +87,14 @@ bool config::validate() const {
         return false;
     }
 
-    if (!batch.empty() && dir.empty()) {
-        std::cerr << "Need to specify an output directory for batch mode.";
+    if (mode == docking_mode::dock && !batch.empty() && dir.empty() && batch_out.empty()) {
+        std::cerr << "Need to specify an output directory or output file for batch mode.";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (!batch_out.empty() && batch.empty()) {
+        std::cerr << "Output file for batch mode is allowed only with batch parameter.";
         std::cerr << std::endl;
         return false;
     }
@@ -82,12 +105,244 @@ bool config::validate() const {
         return false;
     }
 
-    return check_files_exist();
+    if (!summary.empty()) {
+        const auto& extension = std::filesystem::path(summary).extension();
+        if (extension != ".json" && extension != ".csv") {
+            std::cerr << "Summary file should have .json or .csv extension";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    if (!interactions.empty()) {
+        if (std::filesystem::path(interactions).extension() != ".json") {
+            std::cerr << "Interactions file should have .json extension";
+            std::cerr << std::endl;
+            return false;
+        }
+        if (receptor.empty() && receptors.empty()) {
+            std::cerr << "Interactions are calculated only with receptor parameter";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    if (mode != docking_mode::dock && scores.empty()) {
+        std::cerr << "Score only and local only modes require scores file";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (!scores.empty()) {
+        if (mode == docking_mode::dock) {
+            std::cerr << "Scores file is allowed only in score only and local only modes";
+            std::cerr << std::endl;
+            return false;
+        }
+        if (std::filesystem::path(scores).extension() != ".csv") {
+            std::cerr << "Scores file should have .csv extension";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    if (!receptors.empty()) {
+        if (mode != docking_mode::dock) {
+            std::cerr << "Receptors ensemble is allowed only in docking mode";
+            std::cerr << std::endl;
+            return false;
+        }
+        // receptor names are used as suffixes of the output files
+        std::set<std::string> names;
+        for (const auto& r : receptors) {
+            if (!names.insert(std::filesystem::path(r).stem().string()).second) {
+                std::cerr << "Receptors of the ensemble should have different names";
+                std::cerr << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (!sites.empty()) {
+        if (!maps.empty() || scoring == scoring::ad4) {
+            std::cerr << "Sites are allowed only with receptor and vina or vinardo scoring functions";
+            std::cerr << std::endl;
+            return false;
+        }
+        if (mode != docking_mode::dock) {
+            std::cerr << "Sites are allowed only in docking mode";
+            std::cerr << std::endl;
+            return false;
+        }
+        for (const auto& [name, site] : sites) {
+            // site names are used as suffixes of the output files
+            if (name.empty() || !std::all_of(name.cbegin(), name.cend(), [](const auto c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-'; })) {
+                std::cerr << "Wrong site name: [" << name << "]";
+                std::cerr << std::endl;
+                return false;
+            }
+            if (site.size_x <= 0 || site.size_y <= 0 || site.size_z <= 0) {
+                std::cerr << "Size of site [" << name << "] should be positive";
+                std::cerr << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (!receptors.empty() || !sites.empty()) {
+        if (ensemble.empty()) {
+            std::cerr << "Receptors ensemble and sites require ensemble file";
+            std::cerr << std::endl;
+            return false;
+        }
+        // files of the output archive are stored without directories
+        if (!dir.empty()) {
+            std::cerr << "Receptors ensemble and sites require batch_out instead of dir";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    if (!ensemble.empty()) {
+        if (receptors.empty() && sites.empty()) {
+            std::cerr << "Ensemble file is allowed only with receptors ensemble or sites";
+            std::cerr << std::endl;
+            return false;
+        }
+        if (std::filesystem::path(ensemble).extension() != ".csv") {
+            std::cerr << "Ensemble file should have .csv extension";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    for (const auto& function : rescoring) {
+        if (function == scoring) {
+            std::cerr << "Rescoring function should differ from scoring function";
+            std::cerr << std::endl;
+            return false;
+        }
+        // AD4 needs maps which can't be combined with receptor
+        if (function == scoring::ad4 || (receptor.empty() && receptors.empty()) || !flex.empty()) {
+            std::cerr << "Rescoring is supported only with vina or vinardo functions and receptor without flex";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    if (!rescoring.empty() && (mode != docking_mode::dock || output_format == result_format::binary || ligands.size() > 1)) {
+        std::cerr << "Rescoring is allowed only for docking of single ligands with PDBQT output";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (refine_top_k < 0) {
+        std::cerr << "Number of refined poses should not be negative";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (refine_top_k > 0 && (no_refine || (receptor.empty() && receptors.empty()) || !flex.empty() || mode != docking_mode::dock ||
+        output_format == result_format::binary || ligands.size() > 1)) {
+        std::cerr << "Refinement of best poses is allowed only without no_refine for docking of single ligands ";
+        std::cerr << "with receptor without flex and PDBQT output";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (out_poses < 0) {
+        std::cerr << "Number of output poses should not be negative";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (affinity_threshold.has_value() && summary.empty()) {
+        std::cerr << "Affinity threshold requires summary file to list dropped ligands";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (top_k < 0) {
+        std::cerr << "Number of best ligands should not be negative";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (top_k > 0 && (batch.empty() || summary.empty())) {
+        std::cerr << "Best ligands selection is allowed only in batch mode with summary file";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (early_stop && (early_stop_poses < 1 || early_stop_rounds < 1)) {
+        std::cerr << "Early stop requires at least one pose and one stable round";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (early_stop && (early_stop_energy < .0 || early_stop_rmsd < .0)) {
+        std::cerr << "Early stop tolerances should not be negative";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (funnel_exhaustiveness < 0 || funnel_exhaustiveness >= std::max<int64_t>(exhaustiveness, 1)) {
+        std::cerr << "Funnel exhaustiveness should not be negative and should be lower than exhaustiveness";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (funnel_exhaustiveness > 0 && (batch.empty() || summary.empty())) {
+        std::cerr << "Funnel screening is allowed only in batch mode with summary file";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (adaptive_search && batch.empty()) {
+        std::cerr << "Adaptive search is allowed only in batch mode";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (funnel_top_percent < .0 || funnel_top_percent > 100.0) {
+        std::cerr << "Funnel top percent should be between 0 and 100";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    if (output_format == result_format::both && std::filesystem::path(out).extension() == ".bin") {
+        std::cerr << "Output file can't have .bin extension when both output formats are used";
+        std::cerr << std::endl;
+        return false;
+    }
+
+    for (const auto& [name, sha256] : shared) {
+        if (sha256.size() != 64 || sha256.find_first_not_of("0123456789abcdef") != std::string::npos) {
+            std::cerr << "Wrong SHA-256 hash for shared file <" << name << ">";
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    for (const auto& [extension, settings] : compression) {
+        const auto max_level = settings.method == compression_method::zstd ? 22 : settings.method == compression_method::deflate ? 9 : 0;
+        if (settings.level < 0 || settings.level > max_level) {
+            std::cerr << "Wrong compression level for <" << extension << "> files: " << settings.level;
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+
+    return check_files_exist(file_exists);
 }
 
 bool config::check_files_exist() const {
+    return check_files_exist(file_exists_on_disk);
+}
+
+bool config::check_files_exist(const std::function<bool(const std::filesystem::path&)>& file_exists) const {
     for (const auto& file : get_files()) {
-        if (!std::filesystem::exists(file) || !std::filesystem::is_regular_file(file)) {
+        if (!file_exists(file)) {
             std::cerr << "Missing [" << std::filesystem::path(file).filename().string() << "] file specified in config.";
             std::cerr << std::endl;
             return false;
@@ -129,7 +384,17 @@ bool config::load(const std::istream& config_stream, const std::filesystem::path
 
 bool config::load(const jsoncons::basic_json<char>& json, const std::filesystem::path& working_directory) {
     const std::string receptor_field_name = json.contains("receptors") ? "receptors" : json.contains("receptor") ? "receptor" : "";
-    if (!receptor_field_name.empty()) {
+    if (!receptor_field_name.empty() && json[receptor_field_name].is_array()) {
+        for (const auto& r : json[receptor_field_name].array_range()) {
+            const auto& value = std::filesystem::path(r.as<std::string>());
+            if (value.is_absolute()) {
+                std::cerr << "Config should not contain absolute paths" << std::endl;
+                return false;
+            }
+            receptors.emplace_back(std::filesystem::path(working_directory / value).string());
+        }
+    }
+    else if (!receptor_field_name.empty()) {
         const auto& value = std::filesystem::path(json[receptor_field_name].as<std::string>());
         if (value.is_absolute()) {
             std::cerr << "Config should not contain absolute paths" << std::endl;
@@ -220,6 +485,30 @@ bool config::load(const jsoncons::basic_json<char>& json, const std::filesystem:
     if (json.contains("size_z")) {
         size_z = json["size_z"].as<double>();
     }
+    if (json.contains("sites")) {
+        for (const auto& s : json["sites"].object_range()) {
+            docking_site site;
+            if (s.value().contains("center_x")) {
+                site.center_x = s.value()["center_x"].as<double>();
+            }
+            if (s.value().contains("center_y")) {
+                site.center_y = s.value()["center_y"].as<double>();
+            }
+            if (s.value().contains("center_z")) {
+                site.center_z = s.value()["center_z"].as<double>();
+            }
+            if (s.value().contains("size_x")) {
+                site.size_x = s.value()["size_x"].as<double>();
+            }
+            if (s.value().contains("size_y")) {
+                site.size_y = s.value()["size_y"].as<double>();
+            }
+            if (s.value().contains("size_z")) {
+                site.size_z = s.value()["size_z"].as<double>();
+            }
+            sites[s.key()] = site;
+        }
+    }
 
     if (json.contains("out")) {
         const auto& value = std::filesystem::path(json["out"].as<std::string>());
@@ -237,6 +526,14 @@ bool config::load(const jsoncons::basic_json<char>& json, const std::filesystem:
         }
         dir = std::filesystem::path(working_directory / value).string();
     }
+    if (json.contains("batch_out")) {
+        const auto& value = std::filesystem::path(json["batch_out"].as<std::string>());
+        if (value.is_absolute()) {
+            std::cerr << "Config should not contain absolute paths" << std::endl;
+            return false;
+        }
+        batch_out = std::filesystem::path(working_directory / value).string();
+    }
     if (json.contains("write_maps")) {
         const auto& value = std::filesystem::path(json["write_maps"].as<std::string>());
         if (value.is_absolute()) {
@@ -245,10 +542,117 @@ bool config::load(const jsoncons::basic_json<char>& json, const std::filesystem:
         }
         write_maps = std::filesystem::path(working_directory / value).string();
     }
+    if (json.contains("summary")) {
+        const auto& value = std::filesystem::path(json["summary"].as<std::string>());
+        if (value.is_absolute()) {
+            std::cerr << "Config should not contain absolute paths" << std::endl;
+            return false;
+        }
+        summary = std::filesystem::path(working_directory / value).string();
+    }
+    if (json.contains("scores")) {
+        const auto& value = std::filesystem::path(json["scores"].as<std::string>());
+        if (value.is_absolute()) {
+            std::cerr << "Config should not contain absolute paths" << std::endl;
+            return false;
+        }
+        scores = std::filesystem::path(working_directory / value).string();
+    }
+    if (json.contains("ensemble")) {
+        const auto& value = std::filesystem::path(json["ensemble"].as<std::string>());
+        if (value.is_absolute()) {
+            std::cerr << "Config should not contain absolute paths" << std::endl;
+            return false;
+        }
+        ensemble = std::filesystem::path(working_directory / value).string();
+    }
+    if (json.contains("interactions")) {
+        const auto& value = std::filesystem::path(json["interactions"].as<std::string>());
+        if (value.is_absolute()) {
+            std::cerr << "Config should not contain absolute paths" << std::endl;
+            return false;
+        }
+        interactions = std::filesystem::path(working_directory / value).string();
+    }
+    if (json.contains("rescoring")) {
+        for (const auto& r : json["rescoring"].array_range()) {
+            auto s = r.as<std::string>();
+            std::transform(s.begin(), s.end(), s.begin(), [](const auto c) { return std::tolower(c); });
+            const auto& function = magic_enum::enum_cast<::scoring>(s);
+            if (!function.has_value()) {
+                std::cerr << "Wrong rescoring function: [" << s << "]" << std::endl;
+                return false;
+            }
+            rescoring.push_back(function.value());
+        }
+    }
+    if (json.contains("mode")) {
+        auto m = json["mode"].as<std::string>();
+        std::transform(m.begin(), m.end(), m.begin(), [](const auto ch) { return std::tolower(ch); });
+        const auto& value = magic_enum::enum_cast<docking_mode>(m);
+        if (!value.has_value()) {
+            std::cerr << "Wrong mode: [" << m << "]" << std::endl;
+            return false;
+        }
+        mode = value.value();
+    }
+    if (json.contains("output_format")) {
+        auto f = json["output_format"].as<std::string>();
+        std::transform(f.begin(), f.end(), f.begin(), [](const auto ch) { return std::tolower(ch); });
+        const auto& format = magic_enum::enum_cast<result_format>(f);
+        if (!format.has_value()) {
+            std::cerr << "Wrong output format: [" << f << "]" << std::endl;
+            return false;
+        }
+        output_format = format.value();
+    }
+    if (json.contains("out_poses")) {
+        out_poses = json["out_poses"].as<int64_t>();
+    }
+    if (json.contains("affinity_threshold")) {
+        affinity_threshold = json["affinity_threshold"].as<double>();
+    }
+    if (json.contains("top_k")) {
+        top_k = json["top_k"].as<int64_t>();
+    }
+    if (json.contains("compression")) {
+        for (const auto& c : json["compression"].object_range()) {
+            zip_compression settings;
+            if (c.value().contains("method")) {
+                auto m = c.value()["method"].as<std::string>();
+                std::transform(m.begin(), m.end(), m.begin(), [](const auto ch) { return std::tolower(ch); });
+                const auto& method = magic_enum::enum_cast<compression_method>(m);
+                if (!method.has_value()) {
+                    std::cerr << "Wrong compression method: [" << m << "]" << std::endl;
+                    return false;
+                }
+                settings.method = method.value();
+            }
+            if (c.value().contains("level")) {
+                settings.level = c.value()["level"].as<int64_t>();
+            }
+            compression[c.key()] = settings;
+        }
+    }
+    if (json.contains("shared")) {
+        for (const auto& f : json["shared"].object_range()) {
+            const auto& value = std::filesystem::path(f.key()).lexically_normal();
+            if (value.is_absolute() || value.has_root_path() || value.empty() || *value.begin() == "..") {
+                std::cerr << "Config should not contain absolute paths" << std::endl;
+                return false;
+            }
+            auto sha256 = f.value().as<std::string>();
+            std::transform(sha256.begin(), sha256.end(), sha256.begin(), [](const auto ch) { return std::tolower(ch); });
+            shared[value.generic_string()] = sha256;
+        }
+    }
 
     if (json.contains("no_refine")) {
         no_refine = json["no_refine"].as<bool>();
     }
+    if (json.contains("refine_top_k")) {
+        refine_top_k = json["refine_top_k"].as<int64_t>();
+    }
     if (json.contains("force_even_voxels")) {
         force_even_voxels = json["force_even_voxels"].as<bool>();
     }
@@ -354,6 +758,33 @@ bool config::load(const jsoncons::basic_json<char>& json, const std::filesystem:
     if (json.contains("spacing")) {
         spacing = json["spacing"].as<double>();
     }
+    if (json.contains("early_stop")) {
+        early_stop = json["early_stop"].as<bool>();
+    }
+    if (json.contains("early_stop_poses")) {
+        early_stop_poses = json["early_stop_poses"].as<int64_t>();
+    }
+    if (json.contains("early_stop_rounds")) {
+        early_stop_rounds = json["early_stop_rounds"].as<int64_t>();
+    }
+    if (json.contains("early_stop_energy")) {
+        early_stop_energy = json["early_stop_energy"].as<double>();
+    }
+    if (json.contains("early_stop_rmsd")) {
+        early_stop_rmsd = json["early_stop_rmsd"].as<double>();
+    }
+    if (json.contains("funnel_exhaustiveness")) {
+        funnel_exhaustiveness = json["funnel_exhaustiveness"].as<int64_t>();
+    }
+    if (json.contains("funnel_top_percent")) {
+        funnel_top_percent = json["funnel_top_percent"].as<double>();
+    }
+    if (json.contains("funnel_energy_cutoff")) {
+        funnel_energy_cutoff = json["funnel_energy_cutoff"].as<double>();
+    }
+    if (json.contains("adaptive_search")) {
+        adaptive_search = json["adaptive_search"].as<bool>();
+    }
 
     if (out.empty()) {
         out = std::filesystem::path(working_directory / "result.pdbqt").string();
@@ -390,6 +821,23 @@ bool config::save(const std::filesystem::path& config_file_path) const {
         }
     }
 
+    if (!receptors.empty()) {
+        if (!json.begin_array("receptors")) {
+            error_message("receptors");
+            return false;
+        }
+        for (const auto& r : receptors) {
+            if (!json.value(filename_from_file(r))) {
+                error_message("receptors");
+                return false;
+            }
+        }
+        if (!json.end_array()) {
+            error_message("receptors");
+            return false;
+        }
+    }
+
     if (!flex.empty()) {
         if (!json.value("flex", filename_from_file(flex))) {
             error_message("flex");
@@ -481,6 +929,30 @@ bool config::save(const std::filesystem::path& config_file_path) const {
         return false;
     }
 
+    if (!sites.empty()) {
+        if (!json.begin_object("sites")) {
+            error_message("sites");
+            return false;
+        }
+        for (const auto& [name, site] : sites) {
+            if (!json.begin_object(name) ||
+                !json.value("center_x", site.center_x) ||
+                !json.value("center_y", site.center_y) ||
+                !json.value("center_z", site.center_z) ||
+                !json.value("size_x", site.size_x) ||
+                !json.value("size_y", site.size_y) ||
+                !json.value("size_z", site.size_z) ||
+                !json.end_object()) {
+                error_message("sites");
+                return false;
+            }
+        }
+        if (!json.end_object()) {
+            error_message("sites");
+            return false;
+        }
+    }
+
     if (!out.empty()) {
         if (!json.value("out", filename_from_file(out))) {
             error_message("out");
@@ -495,6 +967,13 @@ bool config::save(const std::filesystem::path& config_file_path) const {
         }
     }
 
+    if (!batch_out.empty()) {
+        if (!json.value("batch_out", filename_from_file(batch_out))) {
+            error_message("batch_out");
+            return false;
+        }
+    }
+
     if (!write_maps.empty()) {
         if (!json.value("write_maps", filename_from_file(write_maps))) {
             error_message("write_maps");
@@ -502,11 +981,125 @@ bool config::save(const std::filesystem::path& config_file_path) const {
         }
     }
 
+    if (!summary.empty()) {
+        if (!json.value("summary", filename_from_file(summary))) {
+            error_message("summary");
+            return false;
+        }
+    }
+
+    if (!scores.empty()) {
+        if (!json.value("scores", filename_from_file(scores))) {
+            error_message("scores");
+            return false;
+        }
+    }
+
+    if (!ensemble.empty()) {
+        if (!json.value("ensemble", filename_from_file(ensemble))) {
+            error_message("ensemble");
+            return false;
+        }
+    }
+
+    if (!interactions.empty()) {
+        if (!json.value("interactions", filename_from_file(interactions))) {
+            error_message("interactions");
+            return false;
+        }
+    }
+
+    if (!rescoring.empty()) {
+        if (!json.begin_array("rescoring")) {
+            error_message("rescoring");
+            return false;
+        }
+        for (const auto& function : rescoring) {
+            if (!json.value(std::string(magic_enum::enum_name(function)))) {
+                error_message("rescoring");
+                return false;
+            }
+        }
+        if (!json.end_array()) {
+            error_message("rescoring");
+            return false;
+        }
+    }
+
+    if (!json.value("mode", std::string(magic_enum::enum_name(mode)))) {
+        error_message("mode");
+        return false;
+    }
+
+    if (!json.value("output_format", std::string(magic_enum::enum_name(output_format)))) {
+        error_message("output_format");
+        return false;
+    }
+
+    if (!json.value("out_poses", out_poses)) {
+        error_message("out_poses");
+        return false;
+    }
+
+    if (affinity_threshold.has_value()) {
+        if (!json.value("affinity_threshold", affinity_threshold.value())) {
+            error_message("affinity_threshold");
+            return false;
+        }
+    }
+
+    if (!json.value("top_k", top_k)) {
+        error_message("top_k");
+        return false;
+    }
+
+    if (!compression.empty()) {
+        if (!json.begin_object("compression")) {
+            error_message("compression");
+            return false;
+        }
+        for (const auto& [extension, settings] : compression) {
+            if (!json.begin_object(extension) ||
+                !json.value("method", std::string(magic_enum::enum_name(settings.method))) ||
+                !json.value("level", settings.level) ||
+                !json.end_object()) {
+                error_message("compression");
+                return false;
+            }
+        }
+        if (!json.end_object()) {
+            error_message("compression");
+            return false;
+        }
+    }
+
+    if (!shared.empty()) {
+        if (!json.begin_object("shared")) {
+            error_message("shared");
+            return false;
+        }
+        for (const auto& [name, sha256] : shared) {
+            if (!json.value(name, sha256)) {
+                error_message("shared");
+                return false;
+            }
+        }
+        if (!json.end_object()) {
+            error_message("shared");
+            return false;
+        }
+    }
+
     if (!json.value("no_refine", no_refine)) {
         error_message("no_refine");
         return false;
     }
 
+    if (!json.value("refine_top_k", refine_top_k)) {
+        error_message("refine_top_k");
+        return false;
+    }
+
     if (!json.value("force_even_voxels", force_even_voxels)) {
         error_message("force_even_voxels");
         return false;
@@ -607,6 +1200,53 @@ bool config::save(const std::filesystem::path& config_file_path) const {
         return false;
     }
 
+    if (!json.value("early_stop", early_stop)) {
+        error_message("early_stop");
+        return false;
+    }
+
+    if (!json.value("early_stop_poses", early_stop_poses)) {
+        error_message("early_stop_poses");
+        return false;
+    }
+
+    if (!json.value("early_stop_rounds", early_stop_rounds)) {
+        error_message("early_stop_rounds");
+        return false;
+    }
+
+    if (!json.value("early_stop_energy", early_stop_energy)) {
+        error_message("early_stop_energy");
+        return false;
+    }
+
+    if (!json.value("early_stop_rmsd", early_stop_rmsd)) {
+        error_message("early_stop_rmsd");
+        return false;
+    }
+
+    if (!json.value("funnel_exhaustiveness", funnel_exhaustiveness)) {
+        error_message("funnel_exhaustiveness");
+        return false;
+    }
+
+    if (!json.value("funnel_top_percent", funnel_top_percent)) {
+        error_message("funnel_top_percent");
+        return false;
+    }
+
+    if (funnel_energy_cutoff.has_value()) {
+        if (!json.value("funnel_energy_cutoff", funnel_energy_cutoff.value())) {
+            error_message("funnel_energy_cutoff");
+            return false;
+        }
+    }
+
+    if (!json.value("adaptive_search", adaptive_search)) {
+        error_message("adaptive_search");
+        return false;
+    }
+
     if (!json.end_object()) {
         std::cerr << "Failed to write [" << config_file_path.filename().string() << "] file";
         std::cerr << std::endl;
@@ -623,28 +1263,32 @@ std::vector<std::string> config::get_files() const {
         files.push_back(receptor);
     }
 
-    if (!ligands.empty()) {
-        for (const auto& ligand : ligands) {
-            files.push_back(ligand);
-        }
+    for (const auto& r : receptors) {
+        files.push_back(r);
     }
 
     if (!flex.empty()) {
         files.push_back(flex);
     }
 
-    if (!batch.empty()) {
-        for (const auto& b : batch) {
-            files.push_back(b);
-        }
-    }
-
     if (!maps.empty()) {
         files.emplace_back(get_gpf_filename().string());
         const auto& gpf_files = get_files_from_gpf();
         files.insert(files.end(), gpf_files.cbegin(), gpf_files.cend());
     }
 
+    if (!ligands.empty()) {
+        for (const auto& ligand : ligands) {
+            files.push_back(ligand);
+        }
+    }
+
+    if (!batch.empty()) {
+        for (const auto& b : batch) {
+            files.push_back(b);
+        }
+    }
+
     return files;
 }
 
@@ -684,9 +1328,34 @@ std::filesystem::path config::get_gpf_filename() const {
 std::vector<std::string> config::get_out_files() const {
     std::vector<std::string> files;
 
-    if (!out.empty()) {
+    if (!receptors.empty() || !sites.empty()) {
+        files.push_back(ensemble);
+        for (const auto& [name, target] : get_targets()) {
+            const auto& target_files = target.get_out_files();
+            files.insert(files.end(), target_files.cbegin(), target_files.cend());
+        }
+        return files;
+    }
+
+    if (!out.empty() && output_format != result_format::binary) {
         files.push_back(out);
     }
+    if (!out.empty() && output_format != result_format::pdbqt) {
+        files.push_back(get_binary_out());
+    }
+    if (!batch_out.empty()) {
+        files.push_back(batch_out);
+        files.push_back(get_batch_out_index());
+    }
+    if (!summary.empty()) {
+        files.push_back(summary);
+    }
+    if (!scores.empty()) {
+        files.push_back(scores);
+    }
+    if (!interactions.empty()) {
+        files.push_back(interactions);
+    }
     if (!dir.empty()) {
         for (const auto& file : std::filesystem::directory_iterator(dir)) {
             if (file.is_regular_file()) {
@@ -694,6 +1363,88 @@ std::vector<std::string> config::get_out_files() const {
             }
         }
     }
+    for (const auto& file : get_write_maps_files()) {
+        files.push_back(file);
+    }
+
+    return files;
+}
+
+inline void add_out_suffix(config& config, const std::string& name) {
+    const auto& with_suffix = [&](const std::string& file) -> std::string {
+        if (file.empty()) {
+            return file;
+        }
+        const auto& path = std::filesystem::path(file);
+        return (path.parent_path() / (path.stem().string() + "_" + name + path.extension().string())).string();
+    };
+
+    config.ensemble.clear();
+    config.out = with_suffix(config.out);
+    config.batch_out = with_suffix(config.batch_out);
+    config.summary = with_suffix(config.summary);
+    config.interactions = with_suffix(config.interactions);
+    config.write_maps = with_suffix(config.write_maps);
+}
+
+config config::get_receptor_config(const std::string& conformation) const {
+    auto result = *this;
+    result.receptor = conformation;
+    result.receptors.clear();
+    add_out_suffix(result, std::filesystem::path(conformation).stem().string());
+    return result;
+}
+
+config config::get_site_config(const std::string& site) const {
+    const auto& box = sites.at(site);
+    auto result = *this;
+    result.center_x = box.center_x;
+    result.center_y = box.center_y;
+    result.center_z = box.center_z;
+    result.size_x = box.size_x;
+    result.size_y = box.size_y;
+    result.size_z = box.size_z;
+    result.sites.clear();
+    add_out_suffix(result, site);
+    return result;
+}
+
+std::vector<std::pair<std::string, config>> config::get_targets() const {
+    std::vector<std::pair<std::string, config>> receptor_configs;
+    if (receptors.empty()) {
+        receptor_configs.emplace_back("", *this);
+    }
+    for (const auto& r : receptors) {
+        receptor_configs.emplace_back(std::filesystem::path(r).stem().string(), get_receptor_config(r));
+    }
+
+    std::vector<std::pair<std::string, config>> targets;
+    for (const auto& [receptor_name, receptor_config] : receptor_configs) {
+        if (sites.empty()) {
+            targets.emplace_back(receptor_name, receptor_config);
+        }
+        for (const auto& [site_name, site] : sites) {
+            targets.emplace_back(receptor_name.empty() ? site_name : receptor_name + "_" + site_name, receptor_config.get_site_config(site_name));
+        }
+    }
+    return targets;
+}
+
+std::string config::get_binary_out() const {
+    return std::filesystem::path(out).replace_extension(".bin").string();
+}
+
+std::string config::get_batch_out_index() const {
+    return batch_out + ".idx";
+}
+
+int config::get_out_poses() const {
+    return static_cast<int>(out_poses > 0 ? std::min(out_poses, num_modes) : num_modes);
+}
+
+std::vector<std::string> config::get_write_maps_files() const {
+    std::vector<std::string> files;
+
     if (!write_maps.empty()) {
         const auto m = std::filesystem::path(write_maps);
         for (const auto& file : std::filesystem::directory_iterator(m.parent_path())) {
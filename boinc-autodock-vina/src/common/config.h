@@ -19,23 +19,56 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <optional>
 #include <filesystem>
+#include <functional>
 
 #include <jsoncons/json.hpp>
 
+#include "zip_helper/zip-compression.h"
+
 enum class scoring {
     ad4,
     vina,
     vinardo
 };
 
+enum class docking_mode {
+    dock,
+    score_only,
+    local_only
+};
+
+class docking_site {
+public:
+    double center_x = .0;
+    double center_y = .0;
+    double center_z = .0;
+    double size_x = .0;
+    double size_y = .0;
+    double size_z = .0;
+};
+
+enum class result_format {
+    pdbqt,
+    binary,
+    both
+};
+
 class config {
 public:
     std::string receptor;
+    // ensemble of receptor conformations, all ligands are docked against every receptor one after another
+    std::vector<std::string> receptors;
     std::string flex;
     std::vector<std::string> ligands;
     std::vector<std::string> batch;
     scoring scoring = scoring::vina;
+    // score_only and local_only read every model of ligand files as a pose, no search is done
+    docking_mode mode = docking_mode::dock;
+    // final poses are scored again with these functions, scores are added to every written pose
+    std::vector<::scoring> rescoring;
 
     std::string maps;
     double center_x = .0;
@@ -44,12 +77,34 @@ public:
     double size_x = .0;
     double size_y = .0;
     double size_z = .0;
+    // named search boxes used instead of the box above, every ligand is docked into every site
+    std::map<std::string, docking_site> sites;
 
     std::string out;
     std::string dir;
+    std::string batch_out;
     std::string write_maps;
+    result_format output_format = result_format::pdbqt;
+    std::string summary;
+    // per pose energies of score_only and local_only modes
+    std::string scores;
+    // best affinity of every ligand per receptor and site of the ensemble and over the whole ensemble
+    std::string ensemble;
+    // per pose receptor contacts and ligand efficiency, computed on the client
+    std::string interactions;
+    // number of best poses to write per ligand, 0 writes all num_modes poses
+    int64_t out_poses = 0;
+    // ligands with best affinity above the threshold are listed only in the summary
+    std::optional<double> affinity_threshold;
+    // only poses of the K best ligands of the batch are written, 0 writes all ligands
+    int64_t top_k = 0;
+    std::map<std::string, zip_compression> compression;
+    // input files shared between workunits (BOINC sticky files), logical name to SHA-256
+    std::map<std::string, std::string> shared;
 
     bool no_refine = false;
+    // only the best K poses of every ligand are refined with explicit receptor atoms, 0 follows no_refine
+    int64_t refine_top_k = 0;
     bool force_even_voxels = false;
     double weight_gauss1 = -0.035579;
     double weight_gauss2 = -0.005156;
@@ -71,9 +126,23 @@ public:
     double min_rmsd = 1.0;
     double energy_range = 3.0;
     double spacing = 0.375;
+    // global search in rounds of growing exhaustiveness, stops when the best poses do not change
+    bool early_stop = false;
+    int64_t early_stop_poses = 3;
+    int64_t early_stop_rounds = 1;
+    double early_stop_energy = 0.1;
+    double early_stop_rmsd = 1.0;
+    // batch is docked first with funnel_exhaustiveness, only the best ligands are docked again with exhaustiveness, 0 disables the funnel
+    int64_t funnel_exhaustiveness = 0;
+    double funnel_top_percent = 10.0;
+    std::optional<double> funnel_energy_cutoff;
+    // exhaustiveness and max_evals are split between batch ligands by their torsions and size
+    bool adaptive_search = false;
 
     [[nodiscard]] bool validate() const;
+    [[nodiscard]] bool validate(const std::function<bool(const std::filesystem::path&)>& file_exists) const;
     [[nodiscard]] bool check_files_exist() const;
+    [[nodiscard]] bool check_files_exist(const std::function<bool(const std::filesystem::path&)>& file_exists) const;
     [[nodiscard]] bool load(const std::filesystem::path& config_file_path);
     [[nodiscard]] bool load(const std::istream& config_stream, const std::filesystem::path& working_directory);
     [[nodiscard]] bool load(const jsoncons::basic_json<char>& json, const std::filesystem::path& working_directory);
@@ -83,4 +152,14 @@ public:
     [[nodiscard]] static std::vector<std::string> get_files_from_gpf(const std::filesystem::path& maps);
     [[nodiscard]] std::filesystem::path get_gpf_filename() const;
     [[nodiscard]] std::vector<std::string> get_out_files() const;
+    // config of a single receptor of the ensemble, its output files are suffixed with the receptor name
+    [[nodiscard]] config get_receptor_config(const std::string& conformation) const;
+    // config of a single site, its output files are suffixed with the site name
+    [[nodiscard]] config get_site_config(const std::string& site) const;
+    // single receptor and single site configs in receptor-major order, named as their output suffix
+    [[nodiscard]] std::vector<std::pair<std::string, config>> get_targets() const;
+    [[nodiscard]] std::vector<std::string> get_write_maps_files() const;
+    [[nodiscard]] std::string get_binary_out() const;
+    [[nodiscard]] std::string get_batch_out_index() const;
+    [[nodiscard]] int get_out_poses() const;
 };
@@ -0,0 +1,306 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include <autodock-vina/vina.h>
+
+#include "maps.h"
+#include "estimator.h"
+
+inline bool read_text(const std::filesystem::path& file, std::string& content) {
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Failed to read <" << file.filename().string() << ">" << std::endl;
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+inline bool is_atom_record(const std::string& line) {
+    return line.compare(0, 4, "ATOM") == 0 || line.compare(0, 6, "HETATM") == 0;
+}
+
+double cost_estimate::fpops(const double& flops) const {
+    return cpu_seconds * flops;
+}
+
+estimator::estimator(const cost_model& model) : model(model) {
+}
+
+const cost_model& estimator::get_model() const {
+    return model;
+}
+
+bool estimator::read_ligand(const std::string& pdbqt, ligand_features& features) {
+    std::istringstream stream(pdbqt);
+    std::string line;
+    auto has_torsions = false;
+    while (std::getline(stream, line)) {
+        if (is_atom_record(line)) {
+            if (line.size() < 78) {
+                std::cerr << "Wrong atom record: " << line << std::endl;
+                return false;
+            }
+            auto type = line.substr(77);
+            type.erase(type.find_last_not_of(" \r") + 1);
+            ++features.atoms;
+            if (type != "H" && type != "HD" && type != "HS") {
+                ++features.heavy_atoms;
+                features.types.insert(type);
+            }
+        }
+        else if (line.compare(0, 7, "TORSDOF") == 0) {
+            std::istringstream iss(line.substr(7));
+            has_torsions = static_cast<bool>(iss >> features.torsions);
+        }
+    }
+    if (!has_torsions) {
+        std::cerr << "Ligand has no TORSDOF record" << std::endl;
+        return false;
+    }
+    return features.atoms > 0;
+}
+
+uint64_t estimator::count_atoms(const std::string& pdbqt) {
+    std::istringstream stream(pdbqt);
+    std::string line;
+    uint64_t atoms = 0;
+    while (std::getline(stream, line)) {
+        if (is_atom_record(line)) {
+            ++atoms;
+        }
+    }
+    return atoms;
+}
+
+uint64_t estimator::grid_points(const config& config) {
+    if (!config.maps.empty()) {
+        grid_header header;
+        return maps_reader::read_fld(std::filesystem::path(config.maps + ".maps.fld"), header) ? header.points() : 0;
+    }
+
+    uint64_t points = 1;
+    for (const auto& size : { config.size_x, config.size_y, config.size_z }) {
+        auto voxels = static_cast<uint64_t>(std::ceil(size / config.spacing));
+        if (config.force_even_voxels && voxels % 2 == 1) {
+            ++voxels;
+        }
+        points *= voxels + 1;
+    }
+    return points;
+}
+
+uint64_t estimator::search_steps(const config& config, const ligand_features& ligand) {
+    const auto degrees_of_freedom = ligand.torsions + 6;
+    const auto heuristic = ligand.atoms + 10 * degrees_of_freedom;
+    const auto steps = 70 * 3 * (50 + heuristic) / 2;
+    return config.max_evals > 0 ? std::min(steps, static_cast<uint64_t>(config.max_evals)) : steps;
+}
+
+std::vector<search_budget> estimator::allocate_search(const config& config, const std::vector<ligand_features>& ligands) {
+    std::vector<search_budget> budgets(ligands.size());
+    if (ligands.empty()) {
+        return budgets;
+    }
+
+    double total_freedom = .0;
+    double total_heuristic = .0;
+    for (const auto& ligand : ligands) {
+        total_freedom += static_cast<double>(ligand.torsions + 6);
+        total_heuristic += static_cast<double>(ligand.atoms + 10 * (ligand.torsions + 6));
+    }
+
+    const auto runs = std::max<int64_t>(1, config.exhaustiveness) * static_cast<int64_t>(ligands.size());
+    std::vector<double> shares(ligands.size());
+    int64_t allocated = 0;
+    for (size_t i = 0; i < ligands.size(); ++i) {
+        shares[i] = static_cast<double>(runs) * static_cast<double>(ligands[i].torsions + 6) / total_freedom;
+        budgets[i].exhaustiveness = std::max<int64_t>(1, static_cast<int64_t>(shares[i]));
+        allocated += budgets[i].exhaustiveness;
+
+        if (config.max_evals > 0) {
+            const auto heuristic = static_cast<double>(ligands[i].atoms + 10 * (ligands[i].torsions + 6));
+            budgets[i].max_evals = std::max<int64_t>(1, std::llround(static_cast<double>(config.max_evals) * heuristic * static_cast<double>(ligands.size()) / total_heuristic));
+        }
+    }
+
+    // rounding leftovers go to the largest fractional parts, overruns are taken back from the largest budgets
+    std::vector<size_t> order(ligands.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](const auto& a, const auto& b) {
+        return shares[a] - std::floor(shares[a]) > shares[b] - std::floor(shares[b]);
+    });
+    for (size_t i = 0; allocated < runs; i = (i + 1) % order.size()) {
+        ++budgets[order[i]].exhaustiveness;
+        ++allocated;
+    }
+    while (allocated > runs) {
+        auto& largest = *std::max_element(budgets.begin(), budgets.end(), [](const auto& a, const auto& b) {
+            return a.exhaustiveness < b.exhaustiveness;
+        });
+        if (largest.exhaustiveness <= 1) {
+            break;
+        }
+        --largest.exhaustiveness;
+        --allocated;
+    }
+
+    return budgets;
+}
+
+cost_estimate estimator::estimate(const config& config, const uint64_t& receptor_atoms, const std::vector<ligand_features>& ligands) const {
+    // every receptor and site of an ensemble has its own maps and search, receptor_atoms counts all receptors
+    if (!config.receptors.empty() || !config.sites.empty()) {
+        const auto atoms = receptor_atoms / std::max<uint64_t>(1, config.receptors.size());
+        cost_estimate result;
+        uint64_t peak_memory = 0;
+        for (const auto& [name, target] : config.get_targets()) {
+            const auto& target_estimate = estimate(target, atoms, ligands);
+            result.cpu_seconds += target_estimate.cpu_seconds;
+            peak_memory = std::max(peak_memory, target_estimate.peak_memory);
+        }
+        // sites of a receptor may be docked in parallel
+        result.peak_memory = peak_memory * std::max<uint64_t>(1, config.sites.size());
+        return result;
+    }
+
+    // all ligands of a multiple ligands config are docked together
+    std::vector<ligand_features> docked;
+    if (!config.ligands.empty()) {
+        ligand_features combined;
+        for (const auto& ligand : ligands) {
+            combined.atoms += ligand.atoms;
+            combined.heavy_atoms += ligand.heavy_atoms;
+            combined.torsions += ligand.torsions;
+            combined.types.insert(ligand.types.cbegin(), ligand.types.cend());
+        }
+        docked.push_back(combined);
+    }
+    else {
+        docked = ligands;
+    }
+
+    const auto points = grid_points(config);
+    uint64_t map_types = 0;
+    cost_estimate result;
+    if (!config.maps.empty()) {
+        for (const auto& file : config.get_files_from_gpf()) {
+            if (std::filesystem::path(file).extension() == ".map") {
+                ++map_types;
+            }
+        }
+        result.cpu_seconds += model.map_load_seconds_per_point * static_cast<double>(points * map_types);
+    }
+    else {
+        map_types = config.batch.empty() && !docked.empty() ? docked.front().types.size() : all_map_types;
+        result.cpu_seconds += model.map_seconds_per_point * static_cast<double>(points * map_types);
+    }
+
+    result.cpu_seconds += model.receptor_seconds_per_atom * static_cast<double>(receptor_atoms);
+    for (const auto& ligand : docked) {
+        const auto atom_steps = static_cast<double>(config.exhaustiveness) * static_cast<double>(search_steps(config, ligand)) * static_cast<double>(ligand.atoms);
+        result.cpu_seconds += model.dock_seconds_per_atom_step * atom_steps;
+    }
+
+    result.peak_memory = model.base_memory +
+        model.memory_per_receptor_atom * receptor_atoms +
+        model.memory_per_map_point * points * map_types;
+    return result;
+}
+
+bool estimator::estimate(const config& config, cost_estimate& estimate) const {
+    uint64_t receptor_atoms = 0;
+    auto receptors = config.receptors;
+    receptors.push_back(config.receptor);
+    receptors.push_back(config.flex);
+    for (const auto& file : receptors) {
+        std::string content;
+        if (!file.empty()) {
+            if (!read_text(file, content)) {
+                return false;
+            }
+            receptor_atoms += count_atoms(content);
+        }
+    }
+
+    std::vector<ligand_features> ligands;
+    for (const auto& files : { config.ligands, config.batch }) {
+        for (const auto& file : files) {
+            std::string content;
+            ligand_features features;
+            if (!read_text(file, content) || !read_ligand(content, features)) {
+                std::cerr << "Failed to read ligand <" << std::filesystem::path(file).filename().string() << ">" << std::endl;
+                return false;
+            }
+            ligands.push_back(features);
+        }
+    }
+
+    estimate = this->estimate(config, receptor_atoms, ligands);
+    return true;
+}
+
+bool estimator::calibrate(const std::filesystem::path& samples, cost_model& model) {
+    config config;
+    if (!config.load(samples / "1iep_vina.json") || config.ligands.size() != 1) {
+        std::cerr << "Failed to load benchmark config" << std::endl;
+        return false;
+    }
+
+    std::string ligand;
+    ligand_features features;
+    if (!read_text(config.ligands.front(), ligand) || !read_ligand(ligand, features)) {
+        return false;
+    }
+
+    std::function<void(double)> progress = [](double) {};
+    Vina vina("vina", 1, 1, 0, config.no_refine, &progress);
+    vina.set_receptor(config.receptor);
+    vina.set_ligand_from_string(ligand);
+
+    const auto maps_start = std::clock();
+    vina.compute_vina_maps(config.center_x, config.center_y, config.center_z,
+        config.size_x, config.size_y, config.size_z, config.spacing, config.force_even_voxels);
+    const auto maps_seconds = static_cast<double>(std::clock() - maps_start) / CLOCKS_PER_SEC;
+
+    const auto search_start = std::clock();
+    vina.global_search(1, 1, config.min_rmsd, 0);
+    const auto search_seconds = static_cast<double>(std::clock() - search_start) / CLOCKS_PER_SEC;
+
+    if (maps_seconds <= .0 || search_seconds <= .0 || features.types.empty()) {
+        std::cerr << "Benchmark was too short to calibrate the cost model" << std::endl;
+        return false;
+    }
+
+    auto search_config = config;
+    search_config.max_evals = 0;
+    model.map_seconds_per_point = maps_seconds / static_cast<double>(grid_points(config) * features.types.size());
+    model.dock_seconds_per_atom_step = search_seconds / static_cast<double>(search_steps(search_config, features) * features.atoms);
+    return true;
+}
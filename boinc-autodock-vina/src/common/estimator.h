@@ -0,0 +1,90 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+class ligand_features {
+public:
+    uint64_t atoms = 0;
+    uint64_t heavy_atoms = 0;
+    uint64_t torsions = 0;
+    // AutoDock types of heavy atoms, every type needs its own map
+    std::set<std::string> types;
+};
+
+// Coefficients are CPU seconds of the host the model was calibrated on.
+class cost_model {
+public:
+    double map_seconds_per_point = 1.5e-6;
+    double map_load_seconds_per_point = 5e-8;
+    double receptor_seconds_per_atom = 1e-5;
+    double dock_seconds_per_atom_step = 1.2e-5;
+    uint64_t base_memory = 64 * 1024 * 1024;
+    uint64_t memory_per_receptor_atom = 512;
+    // Vina keeps maps as double values
+    uint64_t memory_per_map_point = sizeof(double);
+};
+
+class cost_estimate {
+public:
+    double cpu_seconds = .0;
+    uint64_t peak_memory = 0;
+
+    // rsc_fpops_est for a host with given FLOPS, should be the FLOPS of the calibration host
+    [[nodiscard]] double fpops(const double& flops) const;
+};
+
+// exhaustiveness and max_evals used for one ligand
+class search_budget {
+public:
+    int64_t exhaustiveness = 0;
+    int64_t max_evals = 0;
+};
+
+class estimator final {
+public:
+    // maps computed by Vina when no ligand is set
+    static constexpr uint64_t all_map_types = 17;
+
+    explicit estimator(const cost_model& model);
+
+    [[nodiscard]] static bool read_ligand(const std::string& pdbqt, ligand_features& features);
+    [[nodiscard]] static uint64_t count_atoms(const std::string& pdbqt);
+    [[nodiscard]] static uint64_t grid_points(const config& config);
+    // Monte Carlo steps of one global search run, as chosen by Vina
+    [[nodiscard]] static uint64_t search_steps(const config& config, const ligand_features& ligand);
+    // splits exhaustiveness * ligands MC runs of the batch by degrees of freedom of every ligand,
+    // max_evals is scaled by the Vina step heuristic (atoms and degrees of freedom) keeping its mean
+    [[nodiscard]] static std::vector<search_budget> allocate_search(const config& config, const std::vector<ligand_features>& ligands);
+
+    [[nodiscard]] cost_estimate estimate(const config& config, const uint64_t& receptor_atoms, const std::vector<ligand_features>& ligands) const;
+    // reads receptor and ligands referenced by config
+    [[nodiscard]] bool estimate(const config& config, cost_estimate& estimate) const;
+    // runs a short docking of the sample data and fits the coefficients to this host
+    [[nodiscard]] static bool calibrate(const std::filesystem::path& samples, cost_model& model);
+    [[nodiscard]] const cost_model& get_model() const;
+private:
+    cost_model model;
+};
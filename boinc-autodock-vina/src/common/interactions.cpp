@@ -0,0 +1,274 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "jsoncons_helper/jsoncons_helper.h"
+
+#include "interactions.h"
+
+namespace {
+// polar hydrogen is bonded to its heavy atom closer than this distance
+constexpr float donor_hydrogen_distance = 1.2f;
+
+bool is_record(const std::string& line, const char* record) {
+    return line.compare(0, std::char_traits<char>::length(record), record) == 0;
+}
+
+std::string trim(const std::string& value) {
+    const auto begin = value.find_first_not_of(' ');
+    if (begin == std::string::npos) {
+        return {};
+    }
+    return value.substr(begin, value.find_last_not_of(' ') - begin + 1);
+}
+
+bool parse_coordinate(const std::string& line, const size_t& position, float& value) {
+    const auto& field = line.substr(position, 8);
+    char* end = nullptr;
+    value = std::strtof(field.c_str(), &end);
+    return end != field.c_str();
+}
+
+bool parse_atom(const std::string& line, pdbqt_atom& atom) {
+    if (line.size() < 78) {
+        return false;
+    }
+
+    atom.name = trim(line.substr(12, 4));
+    const auto& chain = trim(line.substr(21, 1));
+    atom.residue = trim(line.substr(17, 3)) + trim(line.substr(22, 4)) + (chain.empty() ? "" : ":" + chain);
+    atom.type = trim(line.substr(77));
+    return !atom.type.empty() &&
+        parse_coordinate(line, 30, atom.x) &&
+        parse_coordinate(line, 38, atom.y) &&
+        parse_coordinate(line, 46, atom.z);
+}
+
+float distance2(const pdbqt_atom& a, const pdbqt_atom& b) {
+    const auto dx = a.x - b.x;
+    const auto dy = a.y - b.y;
+    const auto dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+bool is_acceptor(const std::string& type) {
+    return type == "OA" || type == "NA" || type == "SA" || type == "OS" || type == "NS";
+}
+
+bool is_polar(const std::string& type) {
+    return type == "N" || type == "S" || is_acceptor(type);
+}
+
+bool is_hydrophobic(const std::string& type) {
+    return type == "C" || type == "A" || type == "Cl" || type == "CL" || type == "Br" || type == "I";
+}
+
+bool is_aromatic(const std::string& type) {
+    return type == "A";
+}
+
+// polar heavy atoms with a polar hydrogen attached
+std::vector<bool> find_donors(const std::vector<pdbqt_atom>& atoms) {
+    std::vector<bool> donors(atoms.size(), false);
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        if (!is_polar(atoms[i].type)) {
+            continue;
+        }
+        for (const auto& atom : atoms) {
+            if (atom.type == "HD" && distance2(atoms[i], atom) < donor_hydrogen_distance * donor_hydrogen_distance) {
+                donors[i] = true;
+                break;
+            }
+        }
+    }
+    return donors;
+}
+}
+
+bool interactions::read_atoms(const std::string& pdbqt, std::vector<pdbqt_atom>& atoms) {
+    std::istringstream stream(pdbqt);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!is_record(line, "ATOM") && !is_record(line, "HETATM")) {
+            continue;
+        }
+        pdbqt_atom atom;
+        if (!parse_atom(line, atom)) {
+            std::cerr << "Wrong atom record: " << line << std::endl;
+            return false;
+        }
+        atoms.emplace_back(std::move(atom));
+    }
+    return true;
+}
+
+bool interactions::is_hydrogen(const std::string& type) {
+    return type == "H" || type == "HD" || type == "HS";
+}
+
+bool interactions::read_models(const std::string& poses, std::vector<std::vector<pdbqt_atom>>& models) {
+    std::istringstream stream(poses);
+    std::string line;
+    auto in_model = false;
+    auto in_flex = false;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (is_record(line, "MODEL")) {
+            models.emplace_back();
+            in_model = true;
+        }
+        else if (is_record(line, "ENDMDL")) {
+            in_model = false;
+        }
+        else if (is_record(line, "BEGIN_RES")) {
+            in_flex = true;
+        }
+        else if (is_record(line, "END_RES")) {
+            in_flex = false;
+        }
+        else if (in_model && !in_flex && (is_record(line, "ATOM") || is_record(line, "HETATM"))) {
+            pdbqt_atom atom;
+            if (!parse_atom(line, atom)) {
+                std::cerr << "Wrong atom record: " << line << std::endl;
+                return false;
+            }
+            models.back().emplace_back(std::move(atom));
+        }
+    }
+    return true;
+}
+
+pose_interactions interactions::analyze(const std::vector<pdbqt_atom>& receptor, const std::vector<pdbqt_atom>& pose, const double& affinity) {
+    pose_interactions result;
+    result.affinity = affinity;
+    result.heavy_atoms = std::count_if(pose.cbegin(), pose.cend(), [](const auto& atom) {
+        return !is_hydrogen(atom.type);
+    });
+    if (result.heavy_atoms > 0) {
+        result.ligand_efficiency = -affinity / static_cast<double>(result.heavy_atoms);
+        result.size_independent_ligand_efficiency = -affinity / std::pow(static_cast<double>(result.heavy_atoms), 0.3);
+    }
+    if (pose.empty()) {
+        return result;
+    }
+
+    // only receptor atoms around the pose can be in contact, hydrogens of donors are kept as well
+    const auto margin = std::max({ hydrogen_bond_distance, hydrophobic_distance, pi_distance }) + donor_hydrogen_distance;
+    float min[3] = { pose.front().x, pose.front().y, pose.front().z };
+    float max[3] = { pose.front().x, pose.front().y, pose.front().z };
+    for (const auto& atom : pose) {
+        min[0] = std::min(min[0], atom.x);
+        min[1] = std::min(min[1], atom.y);
+        min[2] = std::min(min[2], atom.z);
+        max[0] = std::max(max[0], atom.x);
+        max[1] = std::max(max[1], atom.y);
+        max[2] = std::max(max[2], atom.z);
+    }
+    std::vector<pdbqt_atom> pocket;
+    for (const auto& atom : receptor) {
+        if (atom.x >= min[0] - margin && atom.x <= max[0] + margin &&
+            atom.y >= min[1] - margin && atom.y <= max[1] + margin &&
+            atom.z >= min[2] - margin && atom.z <= max[2] + margin) {
+            pocket.push_back(atom);
+        }
+    }
+
+    const auto& pocket_donors = find_donors(pocket);
+    const auto& pose_donors = find_donors(pose);
+    for (size_t i = 0; i < pose.size(); ++i) {
+        const auto& ligand_atom = pose[i];
+        for (size_t j = 0; j < pocket.size(); ++j) {
+            const auto& receptor_atom = pocket[j];
+            const auto d2 = distance2(ligand_atom, receptor_atom);
+            if (d2 <= hydrogen_bond_distance * hydrogen_bond_distance &&
+                ((pose_donors[i] && is_acceptor(receptor_atom.type)) || (pocket_donors[j] && is_acceptor(ligand_atom.type)))) {
+                result.hydrogen_bonds.insert(receptor_atom.residue);
+            }
+            if (d2 <= hydrophobic_distance * hydrophobic_distance &&
+                is_hydrophobic(ligand_atom.type) && is_hydrophobic(receptor_atom.type)) {
+                result.hydrophobic.insert(receptor_atom.residue);
+            }
+            // aromatic atoms close to each other, rings are not perceived
+            if (d2 <= pi_distance * pi_distance &&
+                is_aromatic(ligand_atom.type) && is_aromatic(receptor_atom.type)) {
+                result.pi.insert(receptor_atom.residue);
+            }
+        }
+    }
+
+    return result;
+}
+
+bool interactions::write(const std::vector<ligand_interactions>& ligands, std::string& data) {
+    std::ostringstream stream;
+    jsoncons::json_stream_encoder encoder(stream);
+    const json_encoder_helper json(encoder);
+
+    const auto& write_residues = [&json](const std::string& name, const std::set<std::string>& residues) {
+        if (!json.begin_array(name)) {
+            return false;
+        }
+        for (const auto& residue : residues) {
+            if (!json.value(residue)) {
+                return false;
+            }
+        }
+        return json.end_array();
+    };
+
+    if (!json.begin_object() || !json.begin_array("ligands")) {
+        return false;
+    }
+    for (const auto& ligand : ligands) {
+        if (!json.begin_object() || !json.value("name", ligand.name) || !json.begin_array("poses")) {
+            return false;
+        }
+        for (const auto& pose : ligand.poses) {
+            if (!json.begin_object() ||
+                !json.value("affinity", pose.affinity) ||
+                !json.value("heavy_atoms", pose.heavy_atoms) ||
+                !json.value("ligand_efficiency", pose.ligand_efficiency) ||
+                !json.value("size_independent_ligand_efficiency", pose.size_independent_ligand_efficiency) ||
+                !write_residues("hydrogen_bonds", pose.hydrogen_bonds) ||
+                !write_residues("hydrophobic", pose.hydrophobic) ||
+                !write_residues("pi", pose.pi) ||
+                !json.end_object()) {
+                return false;
+            }
+        }
+        if (!json.end_array() || !json.end_object()) {
+            return false;
+        }
+    }
+    if (!json.end_array() || !json.end_object()) {
+        return false;
+    }
+
+    encoder.flush();
+    data = stream.str();
+    return true;
+}
@@ -0,0 +1,69 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+class pdbqt_atom {
+public:
+    std::string name;
+    // residue name and number with chain, e.g. "ASP381:A"
+    std::string residue;
+    // AutoDock atom type
+    std::string type;
+    float x = .0f;
+    float y = .0f;
+    float z = .0f;
+};
+
+class pose_interactions {
+public:
+    double affinity = .0;
+    uint64_t heavy_atoms = 0;
+    // -affinity / heavy_atoms
+    double ligand_efficiency = .0;
+    // -affinity / heavy_atoms^0.3
+    double size_independent_ligand_efficiency = .0;
+    // receptor residues in contact with the pose
+    std::set<std::string> hydrogen_bonds;
+    std::set<std::string> hydrophobic;
+    std::set<std::string> pi;
+};
+
+class ligand_interactions {
+public:
+    std::string name;
+    std::vector<pose_interactions> poses;
+};
+
+class interactions final {
+public:
+    static constexpr float hydrogen_bond_distance = 3.5f;
+    static constexpr float hydrophobic_distance = 4.0f;
+    static constexpr float pi_distance = 4.5f;
+
+    [[nodiscard]] static bool is_hydrogen(const std::string& type);
+    [[nodiscard]] static bool read_atoms(const std::string& pdbqt, std::vector<pdbqt_atom>& atoms);
+    // splits poses written by Vina into models, flexible residues are skipped
+    [[nodiscard]] static bool read_models(const std::string& poses, std::vector<std::vector<pdbqt_atom>>& models);
+    [[nodiscard]] static pose_interactions analyze(const std::vector<pdbqt_atom>& receptor, const std::vector<pdbqt_atom>& pose, const double& affinity);
+    [[nodiscard]] static bool write(const std::vector<ligand_interactions>& ligands, std::string& data);
+};
@@ -0,0 +1,74 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+
+#include "maps.h"
+
+size_t grid_header::points() const {
+    size_t result = 1;
+    for (const auto& n : nelements) {
+        result *= static_cast<size_t>(n + 1);
+    }
+    return result;
+}
+
+// header fields found: spacing, nelements and center
+inline void read_header_line(const std::string& line, grid_header& header, std::array<bool, 3>& found) {
+    std::istringstream iss(line);
+    std::string key;
+    iss >> key;
+    if (key == "SPACING") {
+        found[0] = static_cast<bool>(iss >> header.spacing);
+    }
+    else if (key == "NELEMENTS") {
+        found[1] = static_cast<bool>(iss >> header.nelements[0] >> header.nelements[1] >> header.nelements[2]);
+    }
+    else if (key == "CENTER") {
+        found[2] = static_cast<bool>(iss >> header.center[0] >> header.center[1] >> header.center[2]);
+    }
+    else if (key == "MACROMOLECULE") {
+        iss >> header.macromolecule;
+    }
+}
+
+bool maps_reader::read_fld(const std::filesystem::path& fld_file, grid_header& header) {
+    std::ifstream fld(fld_file);
+    if (!fld) {
+        std::cerr << "Failed to open maps field file <" << fld_file.filename().string() << ">." << std::endl;
+        return false;
+    }
+
+    std::array<bool, 3> found{};
+    std::string line;
+    while (std::getline(fld, line)) {
+        if (!line.empty() && line[0] == '#') {
+            line.erase(0, 1);
+        }
+        read_header_line(line, header, found);
+    }
+
+    if (!std::all_of(found.cbegin(), found.cend(), [](const auto f) { return f; })) {
+        std::cerr << "Maps field file <" << fld_file.filename().string() << "> has incomplete grid header." << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,38 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+class grid_header {
+public:
+    std::string macromolecule;
+    double spacing = .0;
+    std::array<int64_t, 3> nelements{};
+    std::array<double, 3> center{};
+
+    [[nodiscard]] size_t points() const;
+};
+
+class maps_reader final {
+public:
+    [[nodiscard]] static bool read_fld(const std::filesystem::path& fld_file, grid_header& header);
+};
@@ -0,0 +1,342 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "hash_helper/hash-helper.h"
+
+#include "results.h"
+
+constexpr char results_magic[] = { 'B', 'A', 'V', 'R' };
+constexpr size_t index_offset_position = 12;
+constexpr size_t checksum_position = 20;
+
+class binary_output {
+public:
+    std::string& data;
+
+    void put(const void* value, const size_t& size) {
+        data.append(static_cast<const char*>(value), size);
+    }
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_integral_v<T>);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            data.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void put(const float& value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put(bits);
+    }
+
+    template <typename T>
+    void set(const size_t& offset, const T& value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            data[offset + i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+        }
+    }
+};
+
+class binary_input {
+public:
+    const std::string& data;
+    size_t position = 0;
+
+    [[nodiscard]] bool get(void* value, const size_t& size) {
+        if (data.size() - position < size) {
+            return false;
+        }
+        std::memcpy(value, data.data() + position, size);
+        position += size;
+        return true;
+    }
+
+    template <typename T>
+    [[nodiscard]] bool get(T& value) {
+        static_assert(std::is_integral_v<T>);
+        if (data.size() - position < sizeof(T)) {
+            return false;
+        }
+        uint64_t result = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            result |= static_cast<uint64_t>(static_cast<uint8_t>(data[position + i])) << (8 * i);
+        }
+        value = static_cast<T>(result);
+        position += sizeof(T);
+        return true;
+    }
+
+    [[nodiscard]] bool get(float& value) {
+        uint32_t bits;
+        if (!get(bits)) {
+            return false;
+        }
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+};
+
+inline bool read_header(const std::string& data, uint32_t& ligands, uint64_t& index_offset) {
+    binary_input input{ data };
+
+    char magic[sizeof(results_magic)];
+    uint32_t file_version = 0;
+    uint32_t crc = 0;
+    if (!input.get(magic, sizeof(magic)) || std::memcmp(magic, results_magic, sizeof(magic)) != 0 ||
+        !input.get(file_version) || !input.get(ligands) || !input.get(index_offset) || !input.get(crc)) {
+        std::cerr << "Wrong results file header" << std::endl;
+        return false;
+    }
+    if (file_version != results_file::version) {
+        std::cerr << "Unsupported results file version: " << file_version << std::endl;
+        return false;
+    }
+    if (index_offset < results_file::header_size || index_offset > data.size() ||
+        (data.size() - index_offset) / sizeof(uint64_t) < ligands) {
+        std::cerr << "Wrong results file index" << std::endl;
+        return false;
+    }
+    if (hash_helper::crc32(0, data.data() + results_file::header_size, data.size() - results_file::header_size) != crc) {
+        std::cerr << "Results file checksum mismatch" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+inline bool read_record(const std::string& data, const uint64_t& offset, ligand_result& result) {
+    binary_input input{ data, static_cast<size_t>(offset) };
+
+    uint16_t name_size = 0;
+    uint32_t poses = 0;
+    uint32_t energies = 0;
+    uint32_t atoms = 0;
+    if (offset > data.size() || !input.get(name_size)) {
+        return false;
+    }
+    result.name.resize(name_size);
+    if (!input.get(result.name.data(), name_size) || !input.get(result.input_crc) ||
+        !input.get(poses) || !input.get(energies) || !input.get(atoms)) {
+        return false;
+    }
+    const auto pose_size = (static_cast<uint64_t>(energies) + static_cast<uint64_t>(atoms) * 3) * sizeof(float);
+    if (pose_size != 0 && (data.size() - input.position) / pose_size < poses) {
+        return false;
+    }
+
+    result.poses.resize(poses);
+    for (auto& pose : result.poses) {
+        pose.energies.resize(energies);
+        pose.coordinates.resize(static_cast<size_t>(atoms) * 3);
+        for (auto& value : pose.energies) {
+            if (!input.get(value)) {
+                return false;
+            }
+        }
+        for (auto& value : pose.coordinates) {
+            if (!input.get(value)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool results_file::write(const std::vector<ligand_result>& results, std::string& data) {
+    data.clear();
+    binary_output output{ data };
+
+    output.put(results_magic, sizeof(results_magic));
+    output.put(version);
+    output.put(static_cast<uint32_t>(results.size()));
+    output.put(static_cast<uint64_t>(0));
+    output.put(static_cast<uint32_t>(0));
+
+    std::vector<uint64_t> index;
+    index.reserve(results.size());
+    for (const auto& result : results) {
+        if (result.name.size() > std::numeric_limits<uint16_t>::max()) {
+            std::cerr << "Ligand name <" << result.name << "> is too long for results file" << std::endl;
+            return false;
+        }
+        const auto energies = result.poses.empty() ? 0 : result.poses.front().energies.size();
+        const auto coordinates = result.poses.empty() ? 0 : result.poses.front().coordinates.size();
+        for (const auto& pose : result.poses) {
+            if (pose.energies.size() != energies || pose.coordinates.size() != coordinates || coordinates % 3 != 0) {
+                std::cerr << "Poses of ligand <" << result.name << "> have different sizes" << std::endl;
+                return false;
+            }
+        }
+
+        index.push_back(data.size());
+        output.put(static_cast<uint16_t>(result.name.size()));
+        output.put(result.name.data(), result.name.size());
+        output.put(result.input_crc);
+        output.put(static_cast<uint32_t>(result.poses.size()));
+        output.put(static_cast<uint32_t>(energies));
+        output.put(static_cast<uint32_t>(coordinates / 3));
+        for (const auto& pose : result.poses) {
+            for (const auto& value : pose.energies) {
+                output.put(value);
+            }
+            for (const auto& value : pose.coordinates) {
+                output.put(value);
+            }
+        }
+    }
+
+    const auto index_offset = static_cast<uint64_t>(data.size());
+    for (const auto& offset : index) {
+        output.put(offset);
+    }
+
+    output.set(index_offset_position, index_offset);
+    output.set(checksum_position, hash_helper::crc32(0, data.data() + header_size, data.size() - header_size));
+
+    return true;
+}
+
+bool results_file::count(const std::string& data, size_t& ligands) {
+    uint32_t count = 0;
+    uint64_t index_offset = 0;
+    if (!read_header(data, count, index_offset)) {
+        return false;
+    }
+    ligands = count;
+    return true;
+}
+
+bool results_file::read(const std::string& data, std::vector<ligand_result>& results) {
+    uint32_t count = 0;
+    uint64_t index_offset = 0;
+    if (!read_header(data, count, index_offset)) {
+        return false;
+    }
+
+    binary_input index{ data, static_cast<size_t>(index_offset) };
+    results.clear();
+    results.resize(count);
+    for (auto& result : results) {
+        uint64_t offset = 0;
+        if (!index.get(offset) || !read_record(data, offset, result)) {
+            std::cerr << "Corrupted results file record" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool results_file::read(const std::string& data, const size_t& index, ligand_result& result) {
+    uint32_t count = 0;
+    uint64_t index_offset = 0;
+    if (!read_header(data, count, index_offset)) {
+        return false;
+    }
+    if (index >= count) {
+        std::cerr << "No ligand with index " << index << " in results file" << std::endl;
+        return false;
+    }
+
+    binary_input input{ data, static_cast<size_t>(index_offset + index * sizeof(uint64_t)) };
+    uint64_t offset = 0;
+    if (!input.get(offset) || !read_record(data, offset, result)) {
+        std::cerr << "Corrupted results file record" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void results_stream::add(const std::string& name, const std::string& content) {
+    entries.push_back({ name, stream.size(), content.size() });
+    stream += content;
+}
+
+const std::string& results_stream::data() const {
+    return stream;
+}
+
+std::string results_stream::index() const {
+    std::ostringstream index;
+    for (const auto& entry : entries) {
+        index << entry.offset << " " << entry.size << " " << entry.name << std::endl;
+    }
+    return index.str();
+}
+
+bool results_stream::read_index(const std::string& index, std::vector<stream_entry>& entries) {
+    std::istringstream stream(index);
+    entries.clear();
+
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream iss(line);
+        stream_entry entry;
+        if (!(iss >> entry.offset >> entry.size) || iss.get() != ' ' || !std::getline(iss, entry.name) || entry.name.empty()) {
+            std::cerr << "Wrong results index line: [" << line << "]" << std::endl;
+            return false;
+        }
+        entries.emplace_back(std::move(entry));
+    }
+
+    return true;
+}
+
+void results_targets::add(const std::string& output, const std::string& target) {
+    outputs.emplace_back(output, target);
+}
+
+std::string results_targets::data() const {
+    std::ostringstream data;
+    for (const auto& [output, target] : outputs) {
+        data << output << "\t" << target << std::endl;
+    }
+    return data.str();
+}
+
+bool results_targets::read(const std::string& data, std::map<std::string, std::string>& targets) {
+    std::istringstream stream(data);
+    targets.clear();
+
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        const auto separator = line.find('\t');
+        if (separator == 0 || separator == std::string::npos || separator + 1 == line.size()) {
+            std::cerr << "Wrong results targets line: [" << line << "]" << std::endl;
+            return false;
+        }
+        targets[line.substr(0, separator)] = line.substr(separator + 1);
+    }
+
+    return true;
+}
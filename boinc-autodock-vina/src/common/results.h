@@ -0,0 +1,88 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class pose_result {
+public:
+    // total energy first, then the energy terms reported by Vina
+    std::vector<float> energies;
+    // x, y, z of every ligand heavy atom
+    std::vector<float> coordinates;
+};
+
+class ligand_result {
+public:
+    std::string name;
+    uint32_t input_crc = 0;
+    std::vector<pose_result> poses;
+};
+
+// Binary layout, all values are little-endian:
+//   header: magic "BAVR", version, ligands count, index offset (uint64), CRC32 of everything after the header
+//   ligand record: name length (uint16), name, input CRC32, poses count, energies per pose, atoms count,
+//                  then for every pose its energies and coordinates as float32
+//   index: offset of every ligand record (uint64)
+class results_file final {
+public:
+    static constexpr uint32_t version = 1;
+    static constexpr size_t header_size = 24;
+
+    [[nodiscard]] static bool write(const std::vector<ligand_result>& results, std::string& data);
+    [[nodiscard]] static bool read(const std::string& data, std::vector<ligand_result>& results);
+    [[nodiscard]] static bool count(const std::string& data, size_t& ligands);
+    [[nodiscard]] static bool read(const std::string& data, const size_t& index, ligand_result& result);
+};
+
+class stream_entry {
+public:
+    std::string name;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+// Results of many ligands concatenated into one stream, the sidecar index
+// has one "offset size name" text line per ligand.
+class results_stream final {
+public:
+    void add(const std::string& name, const std::string& content);
+    [[nodiscard]] const std::string& data() const;
+    [[nodiscard]] std::string index() const;
+    [[nodiscard]] static bool read_index(const std::string& index, std::vector<stream_entry>& entries);
+private:
+    std::string stream;
+    std::vector<stream_entry> entries;
+};
+
+// Outputs of several receptors or sites are listed in the sidecar file with the target they were docked to,
+// one "file<TAB>target" text line per output.
+class results_targets final {
+public:
+    static constexpr auto file = "targets.txt";
+
+    void add(const std::string& output, const std::string& target);
+    [[nodiscard]] std::string data() const;
+    // target of every output by its file name
+    [[nodiscard]] static bool read(const std::string& data, std::map<std::string, std::string>& targets);
+private:
+    std::vector<std::pair<std::string, std::string>> outputs;
+};
@@ -0,0 +1,109 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "hash_helper/hash-helper.h"
+
+#include "shared-files.h"
+
+inline std::string cache_key(const std::filesystem::path& file) {
+    std::error_code error;
+    const auto& size = std::filesystem::file_size(file, error);
+    if (error) {
+        return {};
+    }
+    const auto& time = std::filesystem::last_write_time(file, error);
+    if (error) {
+        return {};
+    }
+
+    std::ostringstream key;
+    key << size << " " << time.time_since_epoch().count() << " " << std::filesystem::absolute(file).generic_string();
+    return key.str();
+}
+
+inline bool is_cached(const std::filesystem::path& cache_file, const std::string& sha256, const std::string& key) {
+    std::ifstream cache(cache_file);
+    std::string line;
+    while (std::getline(cache, line)) {
+        const auto& separator = line.find(' ');
+        if (separator != std::string::npos && line.compare(0, separator, sha256) == 0 && line.compare(separator + 1, std::string::npos, key) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool shared_files::verify(const std::filesystem::path& file, const std::string& sha256, const std::filesystem::path& cache_file) {
+    if (!exists(file) || !is_regular_file(file)) {
+        std::cerr << "Missing shared file <" << file.filename().string() << ">" << std::endl;
+        return false;
+    }
+
+    const auto& key = cache_key(file);
+    if (!cache_file.empty() && !key.empty() && is_cached(cache_file, sha256, key)) {
+        return true;
+    }
+
+    std::string hash;
+    if (!hash_helper::sha256(file, hash)) {
+        return false;
+    }
+    if (hash != sha256) {
+        std::cerr << "Shared file <" << file.filename().string() << "> has wrong hash" << std::endl;
+        return false;
+    }
+
+    if (!cache_file.empty() && !key.empty()) {
+        std::ofstream cache(cache_file, std::ios::app);
+        cache << sha256 << " " << key << std::endl;
+    }
+
+    return true;
+}
+
+bool shared_files::link(const std::filesystem::path& file, const std::filesystem::path& target) {
+    std::error_code error;
+    std::filesystem::remove(target, error);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), error);
+    }
+
+    error.clear();
+    std::filesystem::create_hard_link(file, target, error);
+    if (!error) {
+        return true;
+    }
+
+    error.clear();
+    std::filesystem::create_symlink(std::filesystem::absolute(file), target, error);
+    if (!error) {
+        return true;
+    }
+
+    error.clear();
+    std::filesystem::copy_file(file, target, std::filesystem::copy_options::overwrite_existing, error);
+    if (!error) {
+        return true;
+    }
+
+    std::cerr << "Failed to make shared file <" << file.filename().string() << "> available: " << error.message() << std::endl;
+    return false;
+}
@@ -0,0 +1,30 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+class shared_files final {
+public:
+    // files already verified are remembered in cache_file by path, size and modification time,
+    // empty cache_file disables the cache
+    [[nodiscard]] static bool verify(const std::filesystem::path& file, const std::string& sha256, const std::filesystem::path& cache_file);
+    // makes file available under target name without copying it when possible
+    [[nodiscard]] static bool link(const std::filesystem::path& file, const std::filesystem::path& target);
+};
@@ -0,0 +1,196 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include "jsoncons_helper/jsoncons_helper.h"
+
+#include "summary.h"
+
+inline std::string csv_escape(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+
+    std::string result = "\"";
+    for (const auto& c : value) {
+        if (c == '"') {
+            result += '"';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+bool summary_file::write_json(const workunit_summary& summary, std::string& data) {
+    std::ostringstream stream;
+    jsoncons::json_stream_encoder encoder(stream);
+    const json_encoder_helper json(encoder);
+
+    if (!json.begin_object() || !json.begin_array("ligands")) {
+        return false;
+    }
+    for (const auto& ligand : summary.ligands) {
+        if (!json.begin_object() || !json.value("name", ligand.name)) {
+            return false;
+        }
+        if (!ligand.affinities.empty() && !json.value("best_affinity", ligand.affinities.front())) {
+            return false;
+        }
+        if (!json.begin_array("affinities")) {
+            return false;
+        }
+        for (const auto& affinity : ligand.affinities) {
+            if (!json.value(affinity)) {
+                return false;
+            }
+        }
+        if (!json.end_array() ||
+            !json.value("poses", static_cast<uint64_t>(ligand.dropped ? 0 : ligand.affinities.size())) ||
+            !json.value("poses_found", ligand.poses_found) ||
+            !json.value("wall_time", ligand.wall_time) ||
+            !json.value("cpu_time", ligand.cpu_time) ||
+            !json.value("truncated", ligand.truncated) ||
+            !json.value("dropped", ligand.dropped) ||
+            !json.value("search_runs", ligand.search_runs) ||
+            !json.value("saved_runs", ligand.saved_runs) ||
+            !json.value("exhaustiveness", ligand.exhaustiveness) ||
+            !json.value("max_evals", ligand.max_evals) ||
+            !json.value("funnel_runs", ligand.funnel_runs) ||
+            !json.end_object()) {
+            return false;
+        }
+    }
+    if (!json.end_array() ||
+        !json.value("wall_time", summary.wall_time) ||
+        !json.value("cpu_time", summary.cpu_time) ||
+        !json.end_object()) {
+        return false;
+    }
+
+    encoder.flush();
+    data = stream.str();
+    return true;
+}
+
+bool summary_file::write_csv(const workunit_summary& summary, std::string& data) {
+    std::ostringstream stream;
+    stream << std::setprecision(10);
+    stream << "name,best_affinity,poses,poses_found,wall_time,cpu_time,truncated,dropped,search_runs,saved_runs,exhaustiveness,max_evals,funnel_runs,affinities" << std::endl;
+    for (const auto& ligand : summary.ligands) {
+        stream << csv_escape(ligand.name) << ",";
+        if (!ligand.affinities.empty()) {
+            stream << ligand.affinities.front();
+        }
+        stream << "," << (ligand.dropped ? 0 : ligand.affinities.size()) << "," << ligand.poses_found;
+        stream << "," << ligand.wall_time << "," << ligand.cpu_time;
+        stream << "," << (ligand.truncated ? "true" : "false");
+        stream << "," << (ligand.dropped ? "true" : "false");
+        stream << "," << ligand.search_runs << "," << ligand.saved_runs;
+        stream << "," << ligand.exhaustiveness << "," << ligand.max_evals << "," << ligand.funnel_runs << ",";
+        for (size_t i = 0; i < ligand.affinities.size(); ++i) {
+            stream << (i == 0 ? "" : ";") << ligand.affinities[i];
+        }
+        stream << std::endl;
+    }
+
+    data = stream.str();
+    return true;
+}
+
+bool summary_file::write_scores(const std::vector<pose_score>& scores, std::string& data) {
+    std::ostringstream stream;
+    stream << std::setprecision(10);
+    stream << "ligand,pose,energy,terms" << std::endl;
+    for (const auto& score : scores) {
+        stream << csv_escape(score.ligand) << "," << score.pose << ",";
+        if (!score.energies.empty()) {
+            stream << score.energies.front();
+        }
+        stream << ",";
+        for (size_t i = 1; i < score.energies.size(); ++i) {
+            stream << (i == 1 ? "" : ";") << score.energies[i];
+        }
+        stream << std::endl;
+    }
+
+    data = stream.str();
+    return true;
+}
+
+bool summary_file::write_ensemble(const std::vector<std::string>& targets, const std::vector<workunit_summary>& summaries, std::string& data) {
+    if (targets.size() != summaries.size()) {
+        return false;
+    }
+    const auto ligands = summaries.empty() ? 0 : summaries.front().ligands.size();
+    for (const auto& summary : summaries) {
+        if (summary.ligands.size() != ligands) {
+            return false;
+        }
+    }
+
+    std::ostringstream stream;
+    stream << std::setprecision(10);
+    stream << "name,best_affinity,best_target";
+    for (const auto& target : targets) {
+        stream << "," << csv_escape(target);
+    }
+    stream << std::endl;
+    for (size_t i = 0; i < ligands; ++i) {
+        const ligand_summary* best = nullptr;
+        size_t best_target = 0;
+        for (size_t j = 0; j < summaries.size(); ++j) {
+            const auto& ligand = summaries[j].ligands[i];
+            if (!ligand.affinities.empty() && (best == nullptr || ligand.affinities.front() < best->affinities.front())) {
+                best = &ligand;
+                best_target = j;
+            }
+        }
+
+        stream << csv_escape(summaries.front().ligands[i].name) << ",";
+        if (best != nullptr) {
+            stream << best->affinities.front() << "," << csv_escape(targets[best_target]);
+        }
+        else {
+            stream << ",";
+        }
+        for (const auto& summary : summaries) {
+            stream << ",";
+            if (!summary.ligands[i].affinities.empty()) {
+                stream << summary.ligands[i].affinities.front();
+            }
+        }
+        stream << std::endl;
+    }
+
+    data = stream.str();
+    return true;
+}
+
+bool summary_file::write(const std::filesystem::path& file, const workunit_summary& summary, std::string& data) {
+    if (file.extension() == ".csv") {
+        return write_csv(summary, data);
+    }
+    if (file.extension() == ".json") {
+        return write_json(summary, data);
+    }
+
+    std::cerr << "Unsupported summary file format <" << file.filename().string() << ">" << std::endl;
+    return false;
+}
@@ -0,0 +1,75 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class ligand_summary {
+public:
+    std::string name;
+    // affinities of the written poses, best first
+    std::vector<double> affinities;
+    // poses kept by the search, at most num_modes
+    uint64_t poses_found = 0;
+    double wall_time = .0;
+    // CPU time of the whole process while the ligand was docked, so it also counts
+    // output compression and sites docked in parallel meanwhile
+    double cpu_time = .0;
+    // some of the found poses were not written because of out_poses or energy_range
+    bool truncated = false;
+    // best affinity is above the threshold, no poses were written
+    bool dropped = false;
+    // MC runs of all global search rounds and runs saved compared to a single search with full exhaustiveness
+    uint64_t search_runs = 0;
+    int64_t saved_runs = 0;
+    // search budget of the ligand, chosen per ligand with adaptive_search
+    int64_t exhaustiveness = 0;
+    int64_t max_evals = 0;
+    // MC runs of the first funnel stage, not counted in search_runs and saved_runs
+    uint64_t funnel_runs = 0;
+};
+
+class workunit_summary {
+public:
+    std::vector<ligand_summary> ligands;
+    double wall_time = .0;
+    double cpu_time = .0;
+};
+
+class pose_score {
+public:
+    std::string ligand;
+    // number of the model in the ligand file, starting from 1
+    uint64_t pose = 0;
+    // total energy first, followed by the energy terms reported by Vina
+    std::vector<double> energies;
+};
+
+class summary_file final {
+public:
+    [[nodiscard]] static bool write_json(const workunit_summary& summary, std::string& data);
+    [[nodiscard]] static bool write_csv(const workunit_summary& summary, std::string& data);
+    // format is chosen by file extension: .csv or .json
+    [[nodiscard]] static bool write(const std::filesystem::path& file, const workunit_summary& summary, std::string& data);
+    [[nodiscard]] static bool write_scores(const std::vector<pose_score>& scores, std::string& data);
+    // one row per ligand with the best affinity over the ensemble and the best affinity against every receptor and site
+    [[nodiscard]] static bool write_ensemble(const std::vector<std::string>& targets, const std::vector<workunit_summary>& summaries, std::string& data);
+};
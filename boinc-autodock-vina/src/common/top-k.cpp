@@ -0,0 +1,59 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "top-k.h"
+
+#include <algorithm>
+
+namespace {
+// the worst kept ligand is on the top of the heap, ties are resolved by batch order
+bool is_better(const ranked_ligand& a, const ranked_ligand& b) {
+    return a.affinity < b.affinity || (a.affinity == b.affinity && a.order < b.order);
+}
+}
+
+top_k_ligands::top_k_ligands(const size_t& capacity) : capacity(capacity) {
+}
+
+std::optional<ranked_ligand> top_k_ligands::add(ranked_ligand ligand) {
+    std::lock_guard lock(mutex);
+
+    if (heap.size() < capacity) {
+        heap.emplace_back(std::move(ligand));
+        std::push_heap(heap.begin(), heap.end(), is_better);
+        return std::nullopt;
+    }
+
+    if (heap.empty() || !is_better(ligand, heap.front())) {
+        return ligand;
+    }
+
+    std::pop_heap(heap.begin(), heap.end(), is_better);
+    auto evicted = std::move(heap.back());
+    heap.back() = std::move(ligand);
+    std::push_heap(heap.begin(), heap.end(), is_better);
+    return evicted;
+}
+
+std::vector<ranked_ligand> top_k_ligands::take() {
+    std::lock_guard lock(mutex);
+
+    std::sort_heap(heap.begin(), heap.end(), is_better);
+    std::vector<ranked_ligand> ligands;
+    ligands.swap(heap);
+    return ligands;
+}
@@ -0,0 +1,53 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "interactions.h"
+#include "results.h"
+
+class ranked_ligand {
+public:
+    std::string name;
+    double affinity = .0;
+    // position of the ligand in the batch
+    size_t order = 0;
+    std::string out_name;
+    std::string poses;
+    ligand_result result;
+    ligand_interactions interactions;
+};
+
+// Keeps the K ligands with the best (lowest) affinity seen so far, safe to use from several threads.
+class top_k_ligands final {
+public:
+    explicit top_k_ligands(const size_t& capacity);
+
+    // returns the ligand which does not belong to the top K anymore: either the added one or an evicted one
+    [[nodiscard]] std::optional<ranked_ligand> add(ranked_ligand ligand);
+    // returns kept ligands sorted from the best affinity and clears the selection
+    [[nodiscard]] std::vector<ranked_ligand> take();
+private:
+    size_t capacity;
+    std::vector<ranked_ligand> heap;
+    std::mutex mutex;
+};
@@ -0,0 +1,244 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "zip_helper/zip-reader.h"
+#include "zip_helper/zip-writer.h"
+#include "common/results.h"
+#include "assimilator/result-assimilator.h"
+
+class Assimilator_UnitTests : public ::testing::Test {};
+
+inline std::string poses(const char* affinity) {
+    return std::string("MODEL 1\n") +
+        "REMARK VINA RESULT:    " + affinity + "      0.000      0.000\n"
+        "ATOM      1  C1  UNL     1      15.190  53.903  16.917  0.00  0.00    +0.000 C \n"
+        "ENDMDL\n"
+        "MODEL 2\n"
+        "REMARK VINA RESULT:    -1.000      0.000      0.000\n"
+        "ENDMDL\n";
+}
+
+inline bool write_archive(const std::filesystem::path& path, const std::vector<std::pair<std::string, std::string>>& entries) {
+    std::filesystem::remove(path);
+    zip_writer writer(path, {}, 1);
+    for (const auto& [entry, content] : entries) {
+        if (!writer.add(entry, content)) {
+            return false;
+        }
+    }
+    return writer.close();
+}
+
+TEST_F(Assimilator_UnitTests, ReadResults) {
+    const auto& results = std::filesystem::current_path() / "dummy_results";
+    std::filesystem::remove_all(results);
+    std::filesystem::create_directories(results);
+
+    results_stream stream;
+    stream.add("ligand1.pdbqt", poses("-9.500"));
+    stream.add("ligand2.pdbqt", poses("-7.250"));
+    ASSERT_TRUE(write_archive(results / "wu1.zip", { { "batch.pdbqt", stream.data() }, { "batch.pdbqt.idx", stream.index() }, { "summary.json", "{}" } }));
+
+    ligand_result result;
+    result.name = "ligand3.pdbqt";
+    result.poses.push_back({ { -8.f }, { 1.f, 2.f, 3.f } });
+    std::string data;
+    ASSERT_TRUE(results_file::write({ result }, data));
+    ASSERT_TRUE(write_archive(results / "wu2.zip", { { "result.bin", data } }));
+
+    std::vector<assimilated_ligand> ligands;
+    ASSERT_TRUE(result_assimilator::read_result(results / "wu1.zip", ligands));
+    ASSERT_EQ(2, ligands.size());
+    EXPECT_STREQ("wu1", ligands[0].workunit.c_str());
+    EXPECT_STREQ("ligand1.pdbqt", ligands[0].ligand.c_str());
+    EXPECT_FLOAT_EQ(-9.5f, ligands[0].affinity);
+    EXPECT_EQ(0, ligands[0].pose.find("MODEL 1\n"));
+    EXPECT_EQ(ligands[0].pose.size() - 7, ligands[0].pose.find("ENDMDL\n"));
+    EXPECT_FLOAT_EQ(-7.25f, ligands[1].affinity);
+
+    ligands.clear();
+    ASSERT_TRUE(result_assimilator::read_result(results / "wu2.zip", ligands));
+    ASSERT_EQ(1, ligands.size());
+    EXPECT_STREQ("ligand3.pdbqt", ligands[0].ligand.c_str());
+    EXPECT_FLOAT_EQ(-8.f, ligands[0].affinity);
+    EXPECT_STREQ("1.000 2.000 3.000\n", ligands[0].pose.c_str());
+}
+
+TEST_F(Assimilator_UnitTests, AssimilateAndResume) {
+    const auto& results = std::filesystem::current_path() / "dummy_results";
+    const auto& store = std::filesystem::current_path() / "dummy_store";
+    std::filesystem::remove_all(results);
+    std::filesystem::remove_all(store);
+    std::filesystem::create_directories(results);
+
+    for (const auto& name : { "wu1", "wu2", "wu3" }) {
+        ASSERT_TRUE(write_archive(results / (std::string(name) + ".zip"), { { std::string(name) + ".pdbqt", poses("-9.500") } }));
+    }
+
+    const auto& run = [&](const std::vector<std::string>& names) {
+        result_assimilator assimilator(store, 2, 2);
+        if (!assimilator.open()) {
+            return false;
+        }
+        size_t next = 0;
+        return assimilator.run([&](std::filesystem::path& result) {
+            if (next == names.size()) {
+                return false;
+            }
+            result = results / names[next++];
+            return true;
+        });
+    };
+
+    ASSERT_TRUE(run({ "wu1.zip", "wu2.zip" }));
+    ASSERT_TRUE(exists(result_assimilator::segment_path(store, 1)));
+    EXPECT_FALSE(exists(result_assimilator::segment_path(store, 2)));
+
+    // simulate a run interrupted while the index was written
+    {
+        std::ofstream index(store / "ligands.idx", std::ios::app);
+        index << "1 5 partial";
+    }
+
+    ASSERT_TRUE(run({ "wu1.zip", "wu2.zip", "wu3.zip" }));
+    ASSERT_TRUE(exists(result_assimilator::segment_path(store, 2)));
+    EXPECT_FALSE(exists(result_assimilator::segment_path(store, 3)));
+
+    std::vector<assimilated_ligand> ligands;
+    ASSERT_TRUE(result_assimilator::read_segment(result_assimilator::segment_path(store, 1), ligands));
+    ASSERT_TRUE(result_assimilator::read_segment(result_assimilator::segment_path(store, 2), ligands));
+    ASSERT_EQ(3, ligands.size());
+    EXPECT_STREQ("wu3.pdbqt", ligands[2].ligand.c_str());
+    EXPECT_FLOAT_EQ(-9.5f, ligands[2].affinity);
+
+    std::ifstream index(store / "ligands.idx");
+    std::stringstream content;
+    content << index.rdbuf();
+    const auto& lines = content.str();
+    EXPECT_EQ(std::string::npos, lines.find("partial"));
+    EXPECT_NE(std::string::npos, lines.find("2 0 wu3.pdbqt\n"));
+    EXPECT_EQ(3, std::count(lines.cbegin(), lines.cend(), '\n'));
+}
+
+TEST_F(Assimilator_UnitTests, SkipBrokenAndAssimilatedResults) {
+    const auto& results = std::filesystem::current_path() / "dummy_results";
+    const auto& store = std::filesystem::current_path() / "dummy_store";
+    std::filesystem::remove_all(results);
+    std::filesystem::remove_all(store);
+    std::filesystem::create_directories(results);
+
+    ASSERT_TRUE(write_archive(results / "wu1.zip", { { "wu1.pdbqt", poses("-9.500") } }));
+    {
+        std::ofstream broken(results / "wu2.zip");
+        broken << "broken";
+    }
+    ASSERT_TRUE(write_archive(results / "wu3.zip", { { "wu3.pdbqt", poses("-8.500") } }));
+
+    const auto& run = [&](const std::vector<std::string>& names) {
+        result_assimilator assimilator(store, 10, 1);
+        if (!assimilator.open()) {
+            return false;
+        }
+        size_t next = 0;
+        return assimilator.run([&](std::filesystem::path& result) {
+            if (next == names.size()) {
+                return false;
+            }
+            result = results / names[next++];
+            return true;
+        });
+    };
+
+    ASSERT_TRUE(run({ "wu1.zip", "wu2.zip", "wu3.zip" }));
+    ASSERT_TRUE(exists(result_assimilator::segment_path(store, 1)));
+
+    {
+        const zip_reader reader(result_assimilator::segment_path(store, 1));
+        std::string sources;
+        ASSERT_TRUE(reader.read("sources", sources));
+        EXPECT_STREQ("wu1.zip\nwu3.zip\n", sources.c_str());
+    }
+
+    // results are recognized by name, so a new one is assimilated whatever the order
+    ASSERT_TRUE(write_archive(results / "wu0.zip", { { "wu0.pdbqt", poses("-7.500") } }));
+    ASSERT_TRUE(run({ "wu3.zip", "wu0.zip", "wu1.zip" }));
+    ASSERT_TRUE(exists(result_assimilator::segment_path(store, 2)));
+    EXPECT_FALSE(exists(result_assimilator::segment_path(store, 3)));
+
+    std::vector<assimilated_ligand> ligands;
+    ASSERT_TRUE(result_assimilator::read_segment(result_assimilator::segment_path(store, 1), ligands));
+    ASSERT_TRUE(result_assimilator::read_segment(result_assimilator::segment_path(store, 2), ligands));
+    ASSERT_EQ(3, ligands.size());
+    EXPECT_STREQ("wu3.pdbqt", ligands[1].ligand.c_str());
+    EXPECT_STREQ("wu0.pdbqt", ligands[2].ligand.c_str());
+}
+
+TEST_F(Assimilator_UnitTests, StoreTargets) {
+    const auto& results = std::filesystem::current_path() / "dummy_results";
+    const auto& store = std::filesystem::current_path() / "dummy_store";
+    std::filesystem::remove_all(results);
+    std::filesystem::remove_all(store);
+    std::filesystem::create_directories(results);
+
+    // one batch stream per receptor and site, targets are listed next to them
+    std::vector<std::pair<std::string, std::string>> entries;
+    results_targets targets;
+    for (const auto& [target, affinity] : std::vector<std::pair<std::string, const char*>>{ { "rec_a", "-9.500" }, { "rec_b", "-8.500" }, { "rec_b_s1", "-7.500" } }) {
+        results_stream stream;
+        stream.add("ligand1.pdbqt", poses(affinity));
+        entries.emplace_back("results_" + target + ".pdbqt", stream.data());
+        entries.emplace_back("results_" + target + ".pdbqt.idx", stream.index());
+        targets.add("results_" + target + ".pdbqt", target);
+    }
+    entries.emplace_back(results_targets::file, targets.data());
+    ASSERT_TRUE(write_archive(results / "wu1.zip", entries));
+
+    std::vector<assimilated_ligand> ligands;
+    ASSERT_TRUE(result_assimilator::read_result(results / "wu1.zip", ligands));
+    ASSERT_EQ(3, ligands.size());
+    EXPECT_STREQ("rec_a", ligands[0].target.c_str());
+    EXPECT_STREQ("rec_b", ligands[1].target.c_str());
+    EXPECT_STREQ("rec_b_s1", ligands[2].target.c_str());
+
+    {
+        result_assimilator assimilator(store, 10, 1);
+        ASSERT_TRUE(assimilator.open());
+        auto done = false;
+        ASSERT_TRUE(assimilator.run([&](std::filesystem::path& result) {
+            result = results / "wu1.zip";
+            return !std::exchange(done, true);
+        }));
+    }
+
+    ligands.clear();
+    ASSERT_TRUE(result_assimilator::read_segment(result_assimilator::segment_path(store, 1), ligands));
+    ASSERT_EQ(3, ligands.size());
+    EXPECT_STREQ("rec_b", ligands[1].target.c_str());
+    EXPECT_FLOAT_EQ(-8.5f, ligands[1].affinity);
+
+    std::ifstream index(store / "ligands.idx");
+    std::stringstream content;
+    content << index.rdbuf();
+    EXPECT_STREQ("1 0 ligand1.pdbqt rec_a\n1 1 ligand1.pdbqt rec_b\n1 2 ligand1.pdbqt rec_b_s1\n", content.str().c_str());
+}
@@ -1081,3 +1081,600 @@ TEST_F(Config_UnitTests, TestSimpleAd4Scenario) {
     EXPECT_TRUE(res);
     std::filesystem::remove(std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking/1iep_ligand_ad4_out.pdbqt");
 }
+
+TEST_F(Config_UnitTests, LoadCompression) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.begin_object("compression");
+    json_encoder.begin_object("pdbqt");
+    json_encoder.value("method", "Deflate");
+    json_encoder.value("level", static_cast<int64_t>(9));
+    json_encoder.end_object();
+    json_encoder.begin_object("map");
+    json_encoder.value("method", "store");
+    json_encoder.end_object();
+    json_encoder.end_object();
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    ASSERT_EQ(2, config.compression.size());
+    EXPECT_EQ(compression_method::deflate, config.compression["pdbqt"].method);
+    EXPECT_EQ(9, config.compression["pdbqt"].level);
+    EXPECT_EQ(compression_method::store, config.compression["map"].method);
+    EXPECT_EQ(0, config.compression["map"].level);
+}
+
+TEST_F(Config_UnitTests, FailOnWrongCompression) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.begin_object("compression");
+    json_encoder.begin_object("pdbqt");
+    json_encoder.value("method", "lzma");
+    json_encoder.end_object();
+    json_encoder.end_object();
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    EXPECT_FALSE(config.load(dummy_json_file_path));
+
+    config.compression["pdbqt"] = { compression_method::deflate, 10 };
+    EXPECT_FALSE(config.validate());
+}
+
+TEST_F(Config_UnitTests, LoadSharedFiles) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.begin_object("shared");
+    json_encoder.value("receptor_sample", "5AE954C71C0282AB25AD8D290AC2B6A3D310B8190F15F7AB57D4E21A18DC222C");
+    json_encoder.end_object();
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    ASSERT_EQ(1, config.shared.size());
+    EXPECT_STREQ("5ae954c71c0282ab25ad8d290ac2b6a3d310b8190f15f7ab57d4e21a18dc222c", config.shared["receptor_sample"].c_str());
+
+    config.shared["ligand_sample"] = "not a hash";
+    EXPECT_FALSE(config.validate());
+}
+
+TEST_F(Config_UnitTests, LoadOutputFormat) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("output_format", "both");
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_EQ(result_format::both, config.output_format);
+
+    const auto binary_out = std::filesystem::current_path() / "out_sample.bin";
+    EXPECT_STREQ(binary_out.string().c_str(), config.get_binary_out().c_str());
+
+    const auto& files = config.get_out_files();
+    ASSERT_EQ(2, files.size());
+    EXPECT_STREQ(binary_out.string().c_str(), files[1].c_str());
+
+    config.output_format = result_format::binary;
+    ASSERT_EQ(1, config.get_out_files().size());
+    EXPECT_STREQ(binary_out.string().c_str(), config.get_out_files()[0].c_str());
+}
+
+TEST_F(Config_UnitTests, LoadInteractions) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("interactions", "interactions.json");
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    const auto interactions = std::filesystem::current_path() / "interactions.json";
+    EXPECT_STREQ(interactions.string().c_str(), config.interactions.c_str());
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    const auto& files = config.get_out_files();
+    ASSERT_EQ(2, files.size());
+    EXPECT_STREQ(interactions.string().c_str(), files[1].c_str());
+
+    config.interactions = (std::filesystem::current_path() / "interactions.csv").string();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadOutputPruning) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("summary", "summary.csv");
+    json_encoder.value("out_poses", static_cast<int64_t>(1));
+    json_encoder.value("affinity_threshold", -7.5);
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_EQ(1, config.out_poses);
+    EXPECT_EQ(1, config.get_out_poses());
+    ASSERT_TRUE(config.affinity_threshold.has_value());
+    EXPECT_DOUBLE_EQ(-7.5, config.affinity_threshold.value());
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.out_poses = 20;
+    EXPECT_EQ(9, config.get_out_poses());
+    config.out_poses = 0;
+    EXPECT_EQ(9, config.get_out_poses());
+
+    config.top_k = 5;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.top_k = 0;
+
+    config.summary.clear();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadEarlyStop) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("early_stop", true);
+    json_encoder.value("early_stop_poses", static_cast<int64_t>(2));
+    json_encoder.value("early_stop_rounds", static_cast<int64_t>(3));
+    json_encoder.value("early_stop_energy", 0.25);
+    json_encoder.value("early_stop_rmsd", 1.5);
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_TRUE(config.early_stop);
+    EXPECT_EQ(2, config.early_stop_poses);
+    EXPECT_EQ(3, config.early_stop_rounds);
+    EXPECT_DOUBLE_EQ(0.25, config.early_stop_energy);
+    EXPECT_DOUBLE_EQ(1.5, config.early_stop_rmsd);
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.early_stop_rounds = 0;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.early_stop_rounds = 1;
+
+    config.early_stop_rmsd = -1.0;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadFunnel) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.begin_array("batch");
+    json_encoder.value("ligand_sample1");
+    json_encoder.value("ligand_sample2");
+    json_encoder.end_array();
+    json_encoder.value("dir", "out_dir");
+    json_encoder.value("summary", "summary.json");
+    json_encoder.value("funnel_exhaustiveness", static_cast<int64_t>(2));
+    json_encoder.value("funnel_top_percent", 5.0);
+    json_encoder.value("funnel_energy_cutoff", -9.5);
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_EQ(2, config.funnel_exhaustiveness);
+    EXPECT_DOUBLE_EQ(5.0, config.funnel_top_percent);
+    ASSERT_TRUE(config.funnel_energy_cutoff.has_value());
+    EXPECT_DOUBLE_EQ(-9.5, config.funnel_energy_cutoff.value());
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.funnel_exhaustiveness = config.exhaustiveness;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.funnel_exhaustiveness = 2;
+
+    config.funnel_top_percent = 150.0;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.funnel_top_percent = 5.0;
+
+    config.summary.clear();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadAdaptiveSearch) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.begin_array("batch");
+    json_encoder.value("ligand_sample1");
+    json_encoder.value("ligand_sample2");
+    json_encoder.end_array();
+    json_encoder.value("dir", "out_dir");
+    json_encoder.value("adaptive_search", true);
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_TRUE(config.adaptive_search);
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.batch.clear();
+    config.dir.clear();
+    config.ligands.emplace_back("ligand_sample");
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadRescoring) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.begin_array("rescoring");
+    json_encoder.value("Vinardo");
+    json_encoder.end_array();
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    ASSERT_EQ(1, config.rescoring.size());
+    EXPECT_EQ(scoring::vinardo, config.rescoring.front());
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.rescoring.push_back(scoring::vina);
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.rescoring.back() = scoring::ad4;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.rescoring.pop_back();
+
+    config.output_format = result_format::binary;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadRefineTopK) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("refine_top_k", static_cast<int64_t>(3));
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_EQ(3, config.refine_top_k);
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.no_refine = true;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.no_refine = false;
+
+    config.refine_top_k = -1;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadReceptorsEnsemble) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.begin_array("receptors");
+    json_encoder.value("receptor_sample1.pdbqt");
+    json_encoder.value("receptor_sample2.pdbqt");
+    json_encoder.end_array();
+    json_encoder.begin_array("batch");
+    json_encoder.value("ligand_sample1");
+    json_encoder.value("ligand_sample2");
+    json_encoder.end_array();
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("batch_out", "results.pdbqt");
+    json_encoder.value("summary", "summary.csv");
+    json_encoder.value("ensemble", "ensemble.csv");
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    ASSERT_EQ(2, config.receptors.size());
+    EXPECT_TRUE(config.receptor.empty());
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    const auto& receptor_config = config.get_receptor_config(config.receptors.back());
+    EXPECT_STREQ(config.receptors.back().c_str(), receptor_config.receptor.c_str());
+    EXPECT_TRUE(receptor_config.receptors.empty());
+    EXPECT_STREQ((std::filesystem::current_path() / "results_receptor_sample2.pdbqt").string().c_str(), receptor_config.batch_out.c_str());
+    EXPECT_STREQ((std::filesystem::current_path() / "summary_receptor_sample2.csv").string().c_str(), receptor_config.summary.c_str());
+
+    const auto& files = config.get_out_files();
+    ASSERT_EQ(9, files.size());
+    EXPECT_STREQ((std::filesystem::current_path() / "ensemble.csv").string().c_str(), files.front().c_str());
+
+    config.receptors.back() = config.receptors.front();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.receptors.pop_back();
+
+    config.ensemble.clear();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadSites) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample.pdbqt");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("out", "out_sample.pdbqt");
+    json_encoder.value("ensemble", "ensemble.csv");
+    json_encoder.begin_object("sites");
+    json_encoder.begin_object("orthosteric");
+    json_encoder.value("center_x", 15.19);
+    json_encoder.value("center_y", 53.903);
+    json_encoder.value("center_z", 16.917);
+    json_encoder.value("size_x", 20.0);
+    json_encoder.value("size_y", 20.0);
+    json_encoder.value("size_z", 20.0);
+    json_encoder.end_object();
+    json_encoder.begin_object("allosteric");
+    json_encoder.value("center_x", -5.0);
+    json_encoder.value("size_x", 12.0);
+    json_encoder.value("size_y", 12.0);
+    json_encoder.value("size_z", 12.0);
+    json_encoder.end_object();
+    json_encoder.end_object();
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    ASSERT_EQ(2, config.sites.size());
+    EXPECT_DOUBLE_EQ(53.903, config.sites["orthosteric"].center_y);
+    EXPECT_DOUBLE_EQ(.0, config.sites["allosteric"].center_y);
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    const auto& targets = config.get_targets();
+    ASSERT_EQ(2, targets.size());
+    EXPECT_STREQ("allosteric", targets.front().first.c_str());
+    EXPECT_DOUBLE_EQ(-5.0, targets.front().second.center_x);
+    EXPECT_TRUE(targets.front().second.sites.empty());
+    EXPECT_STREQ((std::filesystem::current_path() / "out_sample_allosteric.pdbqt").string().c_str(), targets.front().second.out.c_str());
+
+    config.sites["allosteric"].size_z = .0;
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.sites.erase("allosteric");
+
+    config.sites["wrong/name"] = config.sites["orthosteric"];
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+    config.sites.erase("wrong/name");
+
+    config.ensemble.clear();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadScoreOnlyMode) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.begin_array("batch");
+    json_encoder.value("poses_sample1");
+    json_encoder.value("poses_sample2");
+    json_encoder.end_array();
+    json_encoder.value("mode", "Score_Only");
+    json_encoder.value("scores", "scores.csv");
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_EQ(docking_mode::score_only, config.mode);
+    EXPECT_STREQ((std::filesystem::current_path() / "scores.csv").string().c_str(), config.scores.c_str());
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    config.scores = (std::filesystem::current_path() / "scores.json").string();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+
+    config.scores.clear();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+
+    config.mode = docking_mode::dock;
+    config.scores = (std::filesystem::current_path() / "scores.csv").string();
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
+
+TEST_F(Config_UnitTests, LoadWrongMode) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.value("ligand", "ligand_sample");
+    json_encoder.value("mode", "rescore");
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    EXPECT_FALSE(config.load(dummy_json_file_path));
+}
+
+TEST_F(Config_UnitTests, LoadBatchOut) {
+    const auto& dummy_json_file_path = std::filesystem::current_path() / "dummy.json";
+
+    dummy_ofstream json;
+    json.open(dummy_json_file_path);
+
+    jsoncons::json_stream_encoder jsoncons_encoder(json());
+    const json_encoder_helper json_encoder(jsoncons_encoder);
+
+    json_encoder.begin_object();
+    json_encoder.value("receptor", "receptor_sample");
+    json_encoder.begin_array("batch");
+    json_encoder.value("batch_sample1");
+    json_encoder.value("batch_sample2");
+    json_encoder.end_array();
+    json_encoder.value("batch_out", "batch_out_sample.pdbqt");
+    json_encoder.end_object();
+
+    jsoncons_encoder.flush();
+    json.close();
+
+    config config;
+    ASSERT_TRUE(config.load(dummy_json_file_path));
+    EXPECT_TRUE(config.validate([](const auto&) { return true; }));
+
+    const auto batch_out_sample = std::filesystem::current_path() / "batch_out_sample.pdbqt";
+    EXPECT_STREQ(batch_out_sample.string().c_str(), config.batch_out.c_str());
+    EXPECT_STREQ((batch_out_sample.string() + ".idx").c_str(), config.get_batch_out_index().c_str());
+
+    config.batch.clear();
+    config.ligands.emplace_back("ligand_sample");
+    EXPECT_FALSE(config.validate([](const auto&) { return true; }));
+}
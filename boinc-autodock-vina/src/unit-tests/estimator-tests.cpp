@@ -0,0 +1,113 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "common/config.h"
+#include "common/estimator.h"
+
+class Estimator_UnitTests : public ::testing::Test {};
+
+inline std::string read_sample(const std::string& name) {
+    std::ifstream file(std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking" / name, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST_F(Estimator_UnitTests, ReadLigand) {
+    ligand_features features;
+    ASSERT_TRUE(estimator::read_ligand(read_sample("1iep_ligand.pdbqt"), features));
+    EXPECT_EQ(41, features.atoms);
+    EXPECT_EQ(7, features.torsions);
+    EXPECT_EQ(std::set<std::string>({ "A", "C", "N", "NA", "OA" }), features.types);
+
+    EXPECT_FALSE(estimator::read_ligand("ATOM      1  C   UNL     1       0.000   0.000   0.000  0.00  0.00    +0.000 C\n", features));
+}
+
+TEST_F(Estimator_UnitTests, CountReceptorAtoms) {
+    EXPECT_EQ(2702, estimator::count_atoms(read_sample("1iep_receptor.pdbqt")));
+}
+
+TEST_F(Estimator_UnitTests, GridPoints) {
+    config config;
+    ASSERT_TRUE(config.load(std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking/1iep_vina.json"));
+    EXPECT_EQ(55 * 55 * 55, estimator::grid_points(config));
+
+    config.force_even_voxels = true;
+    EXPECT_EQ(55 * 55 * 55, estimator::grid_points(config));
+    config.size_x = 20.5;
+    EXPECT_EQ(57 * 55 * 55, estimator::grid_points(config));
+}
+
+TEST_F(Estimator_UnitTests, EstimateSampleConfig) {
+    config config;
+    ASSERT_TRUE(config.load(std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking/1iep_vina.json"));
+
+    const estimator estimator{ cost_model() };
+    cost_estimate estimate;
+    ASSERT_TRUE(estimator.estimate(config, estimate));
+    EXPECT_GT(estimate.cpu_seconds, .0);
+    EXPECT_GT(estimate.peak_memory, estimator.get_model().base_memory);
+    EXPECT_DOUBLE_EQ(estimate.cpu_seconds * 2e9, estimate.fpops(2e9));
+
+    config.exhaustiveness *= 2;
+    cost_estimate doubled;
+    ASSERT_TRUE(estimator.estimate(config, doubled));
+    EXPECT_GT(doubled.cpu_seconds, estimate.cpu_seconds);
+    EXPECT_EQ(estimate.peak_memory, doubled.peak_memory);
+
+    config.max_evals = 1000;
+    cost_estimate limited;
+    ASSERT_TRUE(estimator.estimate(config, limited));
+    EXPECT_LT(limited.cpu_seconds, doubled.cpu_seconds);
+}
+
+TEST_F(Estimator_UnitTests, AllocateSearch) {
+    config config;
+    config.exhaustiveness = 8;
+
+    std::vector<ligand_features> ligands(3);
+    ligands[0].atoms = 10;
+    ligands[0].torsions = 0;
+    ligands[1].atoms = 40;
+    ligands[1].torsions = 7;
+    ligands[2].atoms = 60;
+    ligands[2].torsions = 14;
+
+    auto budgets = estimator::allocate_search(config, ligands);
+    ASSERT_EQ(3, budgets.size());
+    EXPECT_EQ(24, budgets[0].exhaustiveness + budgets[1].exhaustiveness + budgets[2].exhaustiveness);
+    EXPECT_LT(budgets[0].exhaustiveness, budgets[1].exhaustiveness);
+    EXPECT_LT(budgets[1].exhaustiveness, budgets[2].exhaustiveness);
+    EXPECT_EQ(0, budgets[0].max_evals);
+
+    config.max_evals = 1000;
+    budgets = estimator::allocate_search(config, ligands);
+    EXPECT_LT(budgets[0].max_evals, 1000);
+    EXPECT_GT(budgets[2].max_evals, 1000);
+    EXPECT_NEAR(3000, budgets[0].max_evals + budgets[1].max_evals + budgets[2].max_evals, 2);
+
+    config.exhaustiveness = 1;
+    budgets = estimator::allocate_search(config, ligands);
+    for (const auto& budget : budgets) {
+        EXPECT_EQ(1, budget.exhaustiveness);
+    }
+}
@@ -0,0 +1,47 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "hash_helper/hash-helper.h"
+#include "dummy-ofstream.h"
+
+class Hash_UnitTests : public ::testing::Test {};
+
+TEST_F(Hash_UnitTests, Crc32) {
+    const std::string data = "123456789";
+    EXPECT_EQ(0xCBF43926u, hash_helper::crc32(0, data.data(), data.size()));
+    EXPECT_EQ(0u, hash_helper::crc32(0, data.data(), 0));
+}
+
+TEST_F(Hash_UnitTests, Crc32Incremental) {
+    const std::string data = "123456789";
+    const auto crc = hash_helper::crc32(0, data.data(), 4);
+    EXPECT_EQ(0xCBF43926u, hash_helper::crc32(crc, data.data() + 4, data.size() - 4));
+}
+
+TEST_F(Hash_UnitTests, Sha256) {
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy.pdbqt");
+
+    std::string hash;
+    ASSERT_TRUE(hash_helper::sha256(std::filesystem::current_path() / "dummy.pdbqt", hash));
+    EXPECT_STREQ("5ae954c71c0282ab25ad8d290ac2b6a3d310b8190f15f7ab57d4e21a18dc222c", hash.c_str());
+    EXPECT_FALSE(hash_helper::sha256(std::filesystem::current_path() / "missing.pdbqt", hash));
+}
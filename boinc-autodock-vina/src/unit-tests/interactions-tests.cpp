@@ -0,0 +1,107 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "common/interactions.h"
+
+class Interactions_UnitTests : public ::testing::Test {};
+
+inline std::string atom_line(const int& serial, const char* name, const char* residue, const int& number, const float& x, const float& y, const float& z, const char* type) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "ATOM  %5d %-4s %3s A%4d    %8.3f%8.3f%8.3f  1.00  0.00     0.000 %-2s\n",
+        serial, name, residue, number, x, y, z, type);
+    return line;
+}
+
+TEST_F(Interactions_UnitTests, ReadSampleFiles) {
+    std::ifstream stream(std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking/1iep_receptor.pdbqt");
+    ASSERT_TRUE(stream.is_open());
+    std::stringstream content;
+    content << stream.rdbuf();
+
+    std::vector<pdbqt_atom> atoms;
+    ASSERT_TRUE(interactions::read_atoms(content.str(), atoms));
+    ASSERT_FALSE(atoms.empty());
+    EXPECT_STREQ("N", atoms[0].name.c_str());
+    EXPECT_STREQ("SER438:A", atoms[0].residue.c_str());
+    EXPECT_STREQ("N", atoms[0].type.c_str());
+    EXPECT_FLOAT_EQ(10.415f, atoms[0].x);
+    EXPECT_FLOAT_EQ(67.633f, atoms[0].y);
+    EXPECT_FLOAT_EQ(32.165f, atoms[0].z);
+    EXPECT_STREQ("HD", atoms[1].type.c_str());
+}
+
+TEST_F(Interactions_UnitTests, ReadModels) {
+    const auto& poses =
+        "MODEL 1\n"
+        "REMARK VINA RESULT:    -9.500      0.000      0.000\n"
+        + atom_line(1, "N1", "UNL", 1, 0.f, 0.f, 0.f, "N")
+        + atom_line(2, "C1", "UNL", 1, 1.f, 0.f, 0.f, "C")
+        + "BEGIN_RES ASP A 381\n"
+        + atom_line(3, "CB", "ASP", 381, 5.f, 0.f, 0.f, "C")
+        + "END_RES ASP A 381\n"
+        + "ENDMDL\n"
+        + "MODEL 2\n"
+        + atom_line(1, "N1", "UNL", 1, 0.f, 1.f, 0.f, "N")
+        + "ENDMDL\n";
+
+    std::vector<std::vector<pdbqt_atom>> models;
+    ASSERT_TRUE(interactions::read_models(poses, models));
+    ASSERT_EQ(2, models.size());
+    EXPECT_EQ(2, models[0].size());
+    EXPECT_EQ(1, models[1].size());
+    EXPECT_FLOAT_EQ(1.f, models[1][0].y);
+
+    models.clear();
+    EXPECT_FALSE(interactions::read_models("MODEL 1\nATOM      1  N1  UNL A   1\nENDMDL\n", models));
+}
+
+TEST_F(Interactions_UnitTests, FindContacts) {
+    const auto& receptor_pdbqt =
+        atom_line(1, "OD1", "ASP", 381, 3.f, 0.f, 0.f, "OA")
+        + atom_line(2, "CB", "ALA", 380, 0.f, 3.8f, 0.f, "C")
+        + atom_line(3, "CZ", "PHE", 382, 0.f, 0.f, 3.9f, "A")
+        + atom_line(4, "CB", "LEU", 383, 20.f, 0.f, 0.f, "C");
+    const auto& pose_pdbqt =
+        atom_line(1, "N1", "UNL", 1, 0.f, 0.f, 0.f, "N")
+        + atom_line(2, "H1", "UNL", 1, 1.f, 0.f, 0.f, "HD")
+        + atom_line(3, "C1", "UNL", 1, 0.f, 0.f, 0.f, "A");
+
+    std::vector<pdbqt_atom> receptor;
+    ASSERT_TRUE(interactions::read_atoms(receptor_pdbqt, receptor));
+    std::vector<pdbqt_atom> pose;
+    ASSERT_TRUE(interactions::read_atoms(pose_pdbqt, pose));
+
+    const auto& result = interactions::analyze(receptor, pose, -8.0);
+    EXPECT_EQ(2, result.heavy_atoms);
+    EXPECT_DOUBLE_EQ(4.0, result.ligand_efficiency);
+    EXPECT_DOUBLE_EQ(8.0 / std::pow(2.0, 0.3), result.size_independent_ligand_efficiency);
+    ASSERT_EQ(1, result.hydrogen_bonds.size());
+    EXPECT_STREQ("ASP381:A", result.hydrogen_bonds.begin()->c_str());
+    ASSERT_EQ(2, result.hydrophobic.size());
+    EXPECT_EQ(1, result.hydrophobic.count("ALA380:A"));
+    EXPECT_EQ(1, result.hydrophobic.count("PHE382:A"));
+    ASSERT_EQ(1, result.pi.size());
+    EXPECT_STREQ("PHE382:A", result.pi.begin()->c_str());
+}
@@ -0,0 +1,36 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "common/maps.h"
+
+class Maps_UnitTests : public ::testing::Test {};
+
+TEST_F(Maps_UnitTests, ReadFld) {
+    grid_header header;
+    ASSERT_TRUE(maps_reader::read_fld(std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking/1iep_receptor.maps.fld", header));
+    EXPECT_STREQ("1iep_receptor.pdbqt", header.macromolecule.c_str());
+    EXPECT_DOUBLE_EQ(0.375, header.spacing);
+    EXPECT_EQ(54, header.nelements[0]);
+    EXPECT_EQ(54, header.nelements[1]);
+    EXPECT_EQ(54, header.nelements[2]);
+    EXPECT_DOUBLE_EQ(15.190, header.center[0]);
+    EXPECT_DOUBLE_EQ(53.903, header.center[1]);
+    EXPECT_DOUBLE_EQ(16.917, header.center[2]);
+    EXPECT_EQ(55 * 55 * 55, header.points());
+}
@@ -0,0 +1,117 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "common/results.h"
+
+class Results_UnitTests : public ::testing::Test {};
+
+inline std::vector<ligand_result> sample_results() {
+    ligand_result first;
+    first.name = "ligand1.pdbqt";
+    first.input_crc = 0x12345678u;
+    first.poses.push_back({ { -10.5f, -11.2f, -0.3f, 0.f, 1.1f }, { 1.f, 2.f, 3.f, -4.5f, 5.25f, 6.125f } });
+    first.poses.push_back({ { -9.25f, -10.f, -0.5f, 0.f, 1.25f }, { 1.5f, 2.5f, 3.5f, -4.f, 5.f, 6.f } });
+
+    ligand_result second;
+    second.name = "ligand2.pdbqt";
+
+    return { first, second };
+}
+
+TEST_F(Results_UnitTests, WriteAndRead) {
+    const auto& results = sample_results();
+
+    std::string data;
+    ASSERT_TRUE(results_file::write(results, data));
+
+    size_t count = 0;
+    ASSERT_TRUE(results_file::count(data, count));
+    EXPECT_EQ(2, count);
+
+    std::vector<ligand_result> read;
+    ASSERT_TRUE(results_file::read(data, read));
+    ASSERT_EQ(2, read.size());
+    EXPECT_STREQ("ligand1.pdbqt", read[0].name.c_str());
+    EXPECT_EQ(0x12345678u, read[0].input_crc);
+    ASSERT_EQ(2, read[0].poses.size());
+    EXPECT_EQ(results[0].poses[0].energies, read[0].poses[0].energies);
+    EXPECT_EQ(results[0].poses[1].coordinates, read[0].poses[1].coordinates);
+    EXPECT_STREQ("ligand2.pdbqt", read[1].name.c_str());
+    EXPECT_TRUE(read[1].poses.empty());
+
+    ligand_result single;
+    ASSERT_TRUE(results_file::read(data, 1, single));
+    EXPECT_STREQ("ligand2.pdbqt", single.name.c_str());
+    ASSERT_TRUE(results_file::read(data, 0, single));
+    EXPECT_FLOAT_EQ(-9.25f, single.poses[1].energies[0]);
+    EXPECT_FALSE(results_file::read(data, 2, single));
+}
+
+TEST_F(Results_UnitTests, FailOnCorruptedData) {
+    std::string data;
+    ASSERT_TRUE(results_file::write(sample_results(), data));
+
+    std::vector<ligand_result> read;
+    auto corrupted = data;
+    corrupted[results_file::header_size + 3] ^= 0x01;
+    EXPECT_FALSE(results_file::read(corrupted, read));
+
+    EXPECT_FALSE(results_file::read(data.substr(0, data.size() - 1), read));
+    EXPECT_FALSE(results_file::read(std::string("BAVR"), read));
+}
+
+TEST_F(Results_UnitTests, FailOnDifferentPoseSizes) {
+    auto results = sample_results();
+    results[0].poses[1].coordinates.pop_back();
+
+    std::string data;
+    EXPECT_FALSE(results_file::write(results, data));
+}
+
+TEST_F(Results_UnitTests, StreamWithIndex) {
+    results_stream stream;
+    stream.add("ligand 1.pdbqt", "MODEL 1\nENDMDL\n");
+    stream.add("ligand2.pdbqt", "MODEL 1\nENDMDL\nMODEL 2\nENDMDL\n");
+
+    std::vector<stream_entry> entries;
+    ASSERT_TRUE(results_stream::read_index(stream.index(), entries));
+    ASSERT_EQ(2, entries.size());
+    EXPECT_STREQ("ligand 1.pdbqt", entries[0].name.c_str());
+    EXPECT_EQ(0, entries[0].offset);
+    EXPECT_STREQ("ligand2.pdbqt", entries[1].name.c_str());
+    EXPECT_STREQ("MODEL 1\nENDMDL\nMODEL 2\nENDMDL\n", stream.data().substr(entries[1].offset, entries[1].size).c_str());
+
+    EXPECT_FALSE(results_stream::read_index("12 ligand.pdbqt\n", entries));
+}
+
+TEST_F(Results_UnitTests, TargetsOfOutputs) {
+    results_targets targets;
+    targets.add("out_rec_a.pdbqt", "rec_a");
+    targets.add("out_rec_a.pdbqt.idx", "rec_a");
+    targets.add("out_rec b.bin", "rec b");
+
+    std::map<std::string, std::string> read;
+    ASSERT_TRUE(results_targets::read(targets.data(), read));
+    ASSERT_EQ(3, read.size());
+    EXPECT_STREQ("rec_a", read["out_rec_a.pdbqt.idx"].c_str());
+    EXPECT_STREQ("rec b", read["out_rec b.bin"].c_str());
+
+    EXPECT_FALSE(results_targets::read("out.pdbqt\n", read));
+    EXPECT_FALSE(results_targets::read("out.pdbqt\t\n", read));
+}
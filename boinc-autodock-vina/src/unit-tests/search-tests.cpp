@@ -0,0 +1,93 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "boinc-autodock-vina/search.h"
+
+class Search_UnitTests : public ::testing::Test {};
+
+TEST_F(Search_UnitTests, RoundsEndWithFullSearch) {
+    EXPECT_EQ(std::vector<int64_t>({ 1, 2, 4, 8 }), early_stop::rounds(8));
+    EXPECT_EQ(std::vector<int64_t>({ 2, 4, 8, 20 }), early_stop::rounds(20));
+    EXPECT_EQ(std::vector<int64_t>({ 1 }), early_stop::rounds(1));
+    EXPECT_EQ(std::vector<int64_t>({ 1, 3 }), early_stop::rounds(3));
+    EXPECT_TRUE(early_stop::rounds(0).empty());
+
+    for (int64_t exhaustiveness = 1; exhaustiveness <= 256; ++exhaustiveness) {
+        const auto& rounds = early_stop::rounds(exhaustiveness);
+        EXPECT_EQ(exhaustiveness, rounds.back());
+        EXPECT_EQ(rounds.cend(), std::adjacent_find(rounds.cbegin(), rounds.cend(), std::greater_equal<>()));
+        // checks before the full search cost at most its runs once more
+        EXPECT_LE(std::accumulate(rounds.cbegin(), rounds.cend(), int64_t(0)), exhaustiveness * 2);
+    }
+}
+
+TEST_F(Search_UnitTests, StablePoses) {
+    config config;
+    config.early_stop_energy = 0.1;
+    config.early_stop_rmsd = 1.0;
+
+    const std::vector<std::vector<double>> energies{ { -9.0, -9.5, 0.5 }, { -8.0 } };
+    const std::vector<std::vector<double>> coordinates{ { 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 }, { 2.0, 2.0, 2.0 } };
+
+    EXPECT_FALSE(early_stop::is_stable({}, {}, energies, coordinates, config));
+    EXPECT_TRUE(early_stop::is_stable(energies, coordinates, energies, coordinates, config));
+    EXPECT_TRUE(early_stop::is_stable(energies, coordinates, { { -9.05 }, { -7.95 } }, coordinates, config));
+    EXPECT_FALSE(early_stop::is_stable(energies, coordinates, { { -9.2 }, { -8.0 } }, coordinates, config));
+    EXPECT_FALSE(early_stop::is_stable(energies, coordinates, { { -9.0 } }, { coordinates.front() }, config));
+
+    // RMSD of the first pose is sqrt((0.25 * 3 + 0.25 * 3) / 2) = 0.866
+    const std::vector<std::vector<double>> moved{ { 0.5, 0.5, 0.5, 1.5, 1.5, 1.5 }, { 2.0, 2.0, 2.0 } };
+    EXPECT_TRUE(early_stop::is_stable(energies, coordinates, energies, moved, config));
+    config.early_stop_rmsd = 0.8;
+    EXPECT_FALSE(early_stop::is_stable(energies, coordinates, energies, moved, config));
+}
+
+TEST_F(Search_UnitTests, SelectFunnel) {
+    std::vector<ligand_summary> screened(10);
+    for (size_t i = 0; i < screened.size(); ++i) {
+        screened[i].name = "ligand" + std::to_string(i);
+        screened[i].affinities = { -5.0 - static_cast<double>(i) };
+    }
+    screened[3].affinities.clear();
+
+    config config;
+    config.funnel_top_percent = 20.0;
+    auto selected = funnel::select(config, screened);
+    EXPECT_EQ(std::vector<bool>({ false, false, false, false, false, false, false, false, true, true }), selected);
+
+    // the top percent is rounded up and counted from all screened ligands
+    config.funnel_top_percent = 25.0;
+    selected = funnel::select(config, screened);
+    EXPECT_EQ(std::vector<bool>({ false, false, false, false, false, false, false, true, true, true }), selected);
+
+    config.funnel_top_percent = 10.0;
+    config.funnel_energy_cutoff = -11.0;
+    selected = funnel::select(config, screened);
+    EXPECT_EQ(std::vector<bool>({ false, false, false, false, false, false, true, true, true, true }), selected);
+
+    config.funnel_top_percent = 0.0;
+    config.funnel_energy_cutoff = -20.0;
+    selected = funnel::select(config, screened);
+    EXPECT_EQ(std::vector<bool>(screened.size(), false), selected);
+}
@@ -0,0 +1,70 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "common/shared-files.h"
+#include "dummy-ofstream.h"
+
+class SharedFiles_UnitTests : public ::testing::Test {};
+
+TEST_F(SharedFiles_UnitTests, VerifyAndCache) {
+    const auto& file = std::filesystem::current_path() / "dummy_receptor.pdbqt";
+    const auto& cache_file = std::filesystem::current_path() / "dummy_cache.txt";
+    const std::string sha256 = "5ae954c71c0282ab25ad8d290ac2b6a3d310b8190f15f7ab57d4e21a18dc222c";
+
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy_receptor.pdbqt");
+    dummy.open(cache_file);
+    dummy.close();
+
+    EXPECT_FALSE(shared_files::verify(file, std::string(64, '0'), cache_file));
+    EXPECT_EQ(0, std::filesystem::file_size(cache_file));
+
+    ASSERT_TRUE(shared_files::verify(file, sha256, cache_file));
+    const auto cache_size = std::filesystem::file_size(cache_file);
+    EXPECT_LT(0, cache_size);
+
+    ASSERT_TRUE(shared_files::verify(file, sha256, cache_file));
+    EXPECT_EQ(cache_size, std::filesystem::file_size(cache_file));
+
+    {
+        std::ofstream stream(file);
+        stream << "Changed" << std::endl;
+    }
+    EXPECT_FALSE(shared_files::verify(file, sha256, cache_file));
+    EXPECT_FALSE(shared_files::verify(std::filesystem::current_path() / "missing.pdbqt", sha256, {}));
+}
+
+TEST_F(SharedFiles_UnitTests, Link) {
+    const auto& target = std::filesystem::current_path() / "dummy_data" / "receptor.pdbqt";
+
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy_receptor.pdbqt");
+
+    ASSERT_TRUE(shared_files::link(std::filesystem::current_path() / "dummy_receptor.pdbqt", target));
+    ASSERT_TRUE(exists(target));
+    EXPECT_EQ(6, std::filesystem::file_size(target));
+
+    ASSERT_TRUE(shared_files::link(std::filesystem::current_path() / "dummy_receptor.pdbqt", target));
+    EXPECT_TRUE(exists(target));
+
+    std::filesystem::remove_all(target.parent_path());
+    EXPECT_TRUE(exists(std::filesystem::current_path() / "dummy_receptor.pdbqt"));
+}
@@ -0,0 +1,107 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <jsoncons/json.hpp>
+
+#include "common/summary.h"
+
+class Summary_UnitTests : public ::testing::Test {};
+
+inline workunit_summary sample_summary() {
+    workunit_summary summary;
+    summary.ligands.push_back({ "ligand1.pdbqt", { -10.5, -9.25 }, 5, 1.5, 3.0, true, false, 3, 5, 8, 0, 2 });
+    summary.ligands.push_back({ "ligand,2.pdbqt", {}, 0, 0.5, 1.0, false, false, 15, -7, 8, 1000, 0 });
+    summary.ligands.push_back({ "ligand3.pdbqt", { -4.5 }, 9, 0.5, 1.0, true, true, 8, 0, 8, 0, 0 });
+    summary.wall_time = 2.5;
+    summary.cpu_time = 4.5;
+    return summary;
+}
+
+TEST_F(Summary_UnitTests, WriteCsv) {
+    std::string data;
+    ASSERT_TRUE(summary_file::write("summary.csv", sample_summary(), data));
+    EXPECT_STREQ(
+        "name,best_affinity,poses,poses_found,wall_time,cpu_time,truncated,dropped,search_runs,saved_runs,exhaustiveness,max_evals,funnel_runs,affinities\n"
+        "ligand1.pdbqt,-10.5,2,5,1.5,3,true,false,3,5,8,0,2,-10.5;-9.25\n"
+        "\"ligand,2.pdbqt\",,0,0,0.5,1,false,false,15,-7,8,1000,0,\n"
+        "ligand3.pdbqt,-4.5,0,9,0.5,1,true,true,8,0,8,0,0,-4.5\n",
+        data.c_str());
+}
+
+TEST_F(Summary_UnitTests, WriteJson) {
+    std::string data;
+    ASSERT_TRUE(summary_file::write("summary.json", sample_summary(), data));
+
+    const auto& json = jsoncons::json::parse(data);
+    ASSERT_EQ(3, json["ligands"].size());
+    EXPECT_STREQ("ligand1.pdbqt", json["ligands"][0]["name"].as<std::string>().c_str());
+    EXPECT_DOUBLE_EQ(-10.5, json["ligands"][0]["best_affinity"].as<double>());
+    EXPECT_EQ(2, json["ligands"][0]["affinities"].size());
+    EXPECT_EQ(5, json["ligands"][0]["poses_found"].as<int64_t>());
+    EXPECT_TRUE(json["ligands"][0]["truncated"].as<bool>());
+    EXPECT_DOUBLE_EQ(3.0, json["ligands"][0]["cpu_time"].as<double>());
+    EXPECT_EQ(3, json["ligands"][0]["search_runs"].as<int64_t>());
+    EXPECT_EQ(-7, json["ligands"][1]["saved_runs"].as<int64_t>());
+    EXPECT_EQ(1000, json["ligands"][1]["max_evals"].as<int64_t>());
+    EXPECT_EQ(2, json["ligands"][0]["funnel_runs"].as<int64_t>());
+    EXPECT_FALSE(json["ligands"][1].contains("best_affinity"));
+    EXPECT_TRUE(json["ligands"][2]["dropped"].as<bool>());
+    EXPECT_DOUBLE_EQ(-4.5, json["ligands"][2]["best_affinity"].as<double>());
+    EXPECT_EQ(0, json["ligands"][2]["poses"].as<int64_t>());
+    EXPECT_DOUBLE_EQ(2.5, json["wall_time"].as<double>());
+}
+
+TEST_F(Summary_UnitTests, WriteScores) {
+    const std::vector<pose_score> scores{
+        { "ligand1.pdbqt", 1, { -8.5, -9.25, 0.75 } },
+        { "ligand1.pdbqt", 2, { -7.0 } },
+        { "ligand,2.pdbqt", 1, {} }
+    };
+
+    std::string data;
+    ASSERT_TRUE(summary_file::write_scores(scores, data));
+    EXPECT_STREQ(
+        "ligand,pose,energy,terms\n"
+        "ligand1.pdbqt,1,-8.5,-9.25;0.75\n"
+        "ligand1.pdbqt,2,-7,\n"
+        "\"ligand,2.pdbqt\",1,,\n",
+        data.c_str());
+}
+
+TEST_F(Summary_UnitTests, WriteEnsemble) {
+    auto second = sample_summary();
+    second.ligands[0].affinities = { -11.0 };
+    second.ligands[2].affinities = { -3.5 };
+
+    std::string data;
+    ASSERT_TRUE(summary_file::write_ensemble({ "receptor1", "receptor2" }, { sample_summary(), second }, data));
+    EXPECT_STREQ(
+        "name,best_affinity,best_target,receptor1,receptor2\n"
+        "ligand1.pdbqt,-11,receptor2,-10.5,-11\n"
+        "\"ligand,2.pdbqt\",,,,\n"
+        "ligand3.pdbqt,-4.5,receptor1,-4.5,-3.5\n",
+        data.c_str());
+
+    second.ligands.pop_back();
+    EXPECT_FALSE(summary_file::write_ensemble({ "receptor1", "receptor2" }, { sample_summary(), second }, data));
+}
+
+TEST_F(Summary_UnitTests, FailOnUnknownFormat) {
+    std::string data;
+    EXPECT_FALSE(summary_file::write("summary.txt", sample_summary(), data));
+}
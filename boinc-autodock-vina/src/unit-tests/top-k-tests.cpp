@@ -0,0 +1,84 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "common/top-k.h"
+
+class TopK_UnitTests : public ::testing::Test {};
+
+TEST_F(TopK_UnitTests, KeepBestLigands) {
+    top_k_ligands top(2);
+
+    const auto& add = [&top](const std::string& name, const double& affinity, const size_t& order) {
+        ranked_ligand ligand;
+        ligand.name = name;
+        ligand.affinity = affinity;
+        ligand.order = order;
+        ligand.poses = "MODEL 1\n";
+        return top.add(std::move(ligand));
+    };
+
+    EXPECT_FALSE(add("ligand1", -7.0, 0).has_value());
+    EXPECT_FALSE(add("ligand2", -9.5, 1).has_value());
+
+    auto rejected = add("ligand3", -6.0, 2);
+    ASSERT_TRUE(rejected.has_value());
+    EXPECT_STREQ("ligand3", rejected->name.c_str());
+    EXPECT_STREQ("MODEL 1\n", rejected->poses.c_str());
+
+    auto evicted = add("ligand4", -8.0, 3);
+    ASSERT_TRUE(evicted.has_value());
+    EXPECT_STREQ("ligand1", evicted->name.c_str());
+
+    evicted = add("ligand5", -8.0, 4);
+    ASSERT_TRUE(evicted.has_value());
+    EXPECT_STREQ("ligand5", evicted->name.c_str());
+
+    const auto& ligands = top.take();
+    ASSERT_EQ(2, ligands.size());
+    EXPECT_STREQ("ligand2", ligands[0].name.c_str());
+    EXPECT_STREQ("ligand4", ligands[1].name.c_str());
+    EXPECT_TRUE(top.take().empty());
+}
+
+TEST_F(TopK_UnitTests, AddFromSeveralThreads) {
+    top_k_ligands top(10);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&top, t]() {
+            for (size_t i = 0; i < 100; ++i) {
+                ranked_ligand ligand;
+                ligand.order = t * 100 + i;
+                ligand.affinity = -static_cast<double>(ligand.order);
+                (void)top.add(std::move(ligand));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto& ligands = top.take();
+    ASSERT_EQ(10, ligands.size());
+    for (size_t i = 0; i < ligands.size(); ++i) {
+        EXPECT_EQ(399 - i, ligands[i].order);
+    }
+}
@@ -0,0 +1,145 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "zip_helper/zip-writer.h"
+#include "wu-validator/result-validator.h"
+
+class Validator_UnitTests : public ::testing::Test {};
+
+inline std::string pose(const int& model, const char* affinity, const char* x) {
+    return "MODEL " + std::to_string(model) + "\n"
+        "REMARK VINA RESULT:    " + affinity + "      0.000      0.000\n"
+        "ATOM      1  C1  UNL     1    " + x + "  53.903  16.917  0.00  0.00    +0.000 C \n"
+        "ENDMDL\n";
+}
+
+TEST_F(Validator_UnitTests, ReadPoses) {
+    std::vector<pose_result> poses;
+    ASSERT_TRUE(result_validator::read_poses(pose(1, "-9.500", "  15.190") + pose(2, "-8.250", "  14.000"), poses));
+    ASSERT_EQ(2, poses.size());
+    ASSERT_EQ(1, poses[0].energies.size());
+    EXPECT_FLOAT_EQ(-9.5f, poses[0].energies[0]);
+    ASSERT_EQ(3, poses[1].coordinates.size());
+    EXPECT_FLOAT_EQ(14.f, poses[1].coordinates[0]);
+    EXPECT_FLOAT_EQ(16.917f, poses[1].coordinates[2]);
+
+    poses.clear();
+    EXPECT_FALSE(result_validator::read_poses("MODEL 1\nATOM      1  C1\nENDMDL\n", poses));
+}
+
+TEST_F(Validator_UnitTests, ComparePosesWithTolerance) {
+    const validation_tolerance tolerance;
+    const auto& poses = pose(1, "-9.500", "  15.190") + pose(2, "-8.250", "  14.000");
+
+    EXPECT_TRUE(result_validator::compare_entry("out.pdbqt", poses, pose(1, "-9.499", "  15.191") + pose(2, "-8.250", "  14.000"), tolerance));
+    EXPECT_FALSE(result_validator::compare_entry("out.pdbqt", poses, pose(1, "-9.000", "  15.190") + pose(2, "-8.250", "  14.000"), tolerance));
+    EXPECT_FALSE(result_validator::compare_entry("out.pdbqt", poses, pose(1, "-9.500", "  16.190") + pose(2, "-8.250", "  14.000"), tolerance));
+    EXPECT_FALSE(result_validator::compare_entry("out.pdbqt", poses, pose(1, "-9.500", "  15.190"), tolerance));
+    EXPECT_TRUE(result_validator::compare_entry("summary.csv", "wall_time\n1.5\n", "wall_time\n2.5\n", tolerance));
+}
+
+TEST_F(Validator_UnitTests, PairSwappedPoses) {
+    const validation_tolerance tolerance;
+    const auto& poses = pose(1, "-9.500", "  15.190") + pose(2, "-9.450", "  11.000") + pose(3, "-8.000", "  14.000");
+
+    EXPECT_TRUE(result_validator::compare_entry("out.pdbqt", poses, pose(1, "-9.470", "  11.010") + pose(2, "-9.480", "  15.180") + pose(3, "-8.000", "  14.000"), tolerance));
+    EXPECT_FALSE(result_validator::compare_entry("out.pdbqt", poses, pose(1, "-9.470", "  15.190") + pose(2, "-9.480", "  15.180") + pose(3, "-8.000", "  14.000"), tolerance));
+}
+
+TEST_F(Validator_UnitTests, CompareCsvWithTolerance) {
+    const validation_tolerance tolerance;
+    const std::string scores =
+        "ligand,pose,energy,terms\n"
+        "\"ligand,1.pdbqt\",1,-8.5,-9.25;0.75\n"
+        "ligand2.pdbqt,1,,\n";
+
+    EXPECT_TRUE(result_validator::compare_csv(scores, "ligand,pose,energy,terms\n\"ligand,1.pdbqt\",1,-8.45,-9.3;0.75\nligand2.pdbqt,1,,\n", tolerance));
+    EXPECT_FALSE(result_validator::compare_csv(scores, "ligand,pose,energy,terms\n\"ligand,1.pdbqt\",1,-8.5,-9.25;1.75\nligand2.pdbqt,1,,\n", tolerance));
+    EXPECT_FALSE(result_validator::compare_csv(scores, "ligand,pose,energy,terms\n\"ligand,1.pdbqt\",1,-8.5,-9.25\nligand2.pdbqt,1,,\n", tolerance));
+    EXPECT_FALSE(result_validator::compare_csv(scores, "ligand,pose,energy,terms\n\"ligand,1.pdbqt\",1,-8.5,-9.25;0.75\nligand2.pdbqt,1,-7,\n", tolerance));
+    EXPECT_FALSE(result_validator::compare_csv(scores, "ligand,pose,energy,terms\n\"ligand,1.pdbqt\",1,-8.5,-9.25;0.75\n", tolerance));
+
+    // near tie of the best target
+    EXPECT_TRUE(result_validator::compare_entry("ensemble.csv",
+        "name,best_affinity,best_target,rec_a,rec_b\nligand.pdbqt,-9.5,rec_a,-9.5,-9.45\n",
+        "name,best_affinity,best_target,rec_a,rec_b\nligand.pdbqt,-9.48,rec_b,-9.46,-9.48\n", tolerance));
+    EXPECT_FALSE(result_validator::compare_entry("ensemble.csv",
+        "name,best_affinity,best_target,rec_a,rec_b\nligand.pdbqt,-9.5,rec_a,-9.5,-9.45\n",
+        "name,best_affinity,best_target,rec_b,rec_a\nligand.pdbqt,-9.5,rec_a,-9.45,-9.5\n", tolerance));
+}
+
+TEST_F(Validator_UnitTests, CompareJsonWithTolerance) {
+    const validation_tolerance tolerance;
+    const std::string interactions = R"({"ligands":[{"name":"ligand.pdbqt","poses":[{"affinity":-9.5,"heavy_atoms":20,"hydrogen_bonds":["ASP381:A"]}]}]})";
+
+    EXPECT_TRUE(result_validator::compare_json(interactions, R"({"ligands":[{"name":"ligand.pdbqt","poses":[{"affinity":-9.45,"heavy_atoms":20,"hydrogen_bonds":[]}]}]})", tolerance));
+    EXPECT_FALSE(result_validator::compare_json(interactions, R"({"ligands":[{"name":"ligand.pdbqt","poses":[{"affinity":-8.5,"heavy_atoms":20,"hydrogen_bonds":["ASP381:A"]}]}]})", tolerance));
+    EXPECT_FALSE(result_validator::compare_json(interactions, R"({"ligands":[{"name":"ligand2.pdbqt","poses":[{"affinity":-9.5,"heavy_atoms":20,"hydrogen_bonds":["ASP381:A"]}]}]})", tolerance));
+    EXPECT_FALSE(result_validator::compare_json(interactions, R"({"ligands":[{"name":"ligand.pdbqt","poses":[]}]})", tolerance));
+    EXPECT_TRUE(result_validator::compare_entry("summary.json", R"({"ligands":[],"wall_time":1.5,"cpu_time":1.0})", R"({"ligands":[],"wall_time":2.5,"cpu_time":2.0})", tolerance));
+    EXPECT_FALSE(result_validator::compare_json(interactions, "{", tolerance));
+}
+
+TEST_F(Validator_UnitTests, CompareBinaryResults) {
+    ligand_result result;
+    result.name = "ligand.pdbqt";
+    result.poses.push_back({ { -9.5f, -1.f }, { 1.f, 2.f, 3.f } });
+
+    std::string data1;
+    ASSERT_TRUE(results_file::write({ result }, data1));
+    result.poses[0].energies[1] = -1.05f;
+    result.poses[0].coordinates[0] = 1.1f;
+    std::string data2;
+    ASSERT_TRUE(results_file::write({ result }, data2));
+    EXPECT_TRUE(result_validator::compare_entry("out.bin", data1, data2, {}));
+
+    result.name = "other.pdbqt";
+    ASSERT_TRUE(results_file::write({ result }, data2));
+    EXPECT_FALSE(result_validator::compare_entry("out.bin", data1, data2, {}));
+}
+
+TEST_F(Validator_UnitTests, ValidateArchives) {
+    const auto& write_archive = [](const std::string& name, const std::vector<std::pair<std::string, std::string>>& entries) {
+        const auto& path = std::filesystem::current_path() / name;
+        std::filesystem::remove(path);
+        zip_writer writer(path, {}, 1);
+        for (const auto& [entry, content] : entries) {
+            if (!writer.add(entry, content)) {
+                return false;
+            }
+        }
+        return writer.close();
+    };
+
+    ASSERT_TRUE(write_archive("result1.zip", { { "batch.pdbqt", pose(1, "-9.500", "  15.190") }, { "summary.json", "{}" } }));
+    ASSERT_TRUE(write_archive("result2.zip", { { "summary.json", "{ }" }, { "batch.pdbqt", pose(1, "-9.550", "  15.200") } }));
+    ASSERT_TRUE(write_archive("result3.zip", { { "batch.pdbqt", pose(1, "-9.550", "  15.200") } }));
+
+    const auto& result1 = std::filesystem::current_path() / "result1.zip";
+    const auto& result2 = std::filesystem::current_path() / "result2.zip";
+    const auto& result3 = std::filesystem::current_path() / "result3.zip";
+    EXPECT_TRUE(result_validator::validate(result1, result2, {}));
+    EXPECT_FALSE(result_validator::validate(result1, result2, { 0.01, 0.5 }));
+    EXPECT_FALSE(result_validator::validate(result1, result3, {}));
+
+    ASSERT_TRUE(write_archive("result4.zip", { { "batch.pdbqt", pose(1, "-9.550", "  15.200") }, { "results.bin", "BAVR" } }));
+    EXPECT_TRUE(result_validator::check(result3));
+    EXPECT_FALSE(result_validator::check(std::filesystem::current_path() / "result4.zip"));
+    EXPECT_FALSE(result_validator::check(std::filesystem::current_path() / "missing.zip"));
+}
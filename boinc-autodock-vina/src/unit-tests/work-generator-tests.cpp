@@ -0,0 +1,118 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "zip_helper/zip-reader.h"
+#include "hash_helper/hash-helper.h"
+#include "work-generator/workunit-generator.h"
+#include "dummy-ofstream.h"
+
+class WorkGenerator_UnitTests : public ::testing::Test {};
+
+TEST_F(WorkGenerator_UnitTests, CreateBatchWorkunits) {
+    const auto& samples = std::filesystem::current_path() / "boinc-autodock-vina/samples/basic_docking";
+    const auto& input = std::filesystem::current_path() / "dummy_generator_input";
+    const auto& output = std::filesystem::current_path() / "dummy_generator_output";
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(output);
+    std::filesystem::create_directories(input);
+
+    std::filesystem::copy_file(samples / "1iep_receptor.pdbqt", input / "1iep_receptor.pdbqt");
+    const std::vector<std::filesystem::path> ligands{ input / "ligand1.pdbqt", input / "ligand2.pdbqt", input / "ligand3.pdbqt" };
+    for (const auto& ligand : ligands) {
+        std::filesystem::copy_file(samples / "1iep_ligand.pdbqt", ligand);
+    }
+
+    dummy_ofstream stream;
+    stream.open(input / "template.json");
+    stream() <<
+        R"({"receptor": "1iep_receptor.pdbqt", "center_x": 15.190, "center_y": 53.903, "center_z": 16.917,)" <<
+        R"( "size_x": 20.0, "size_y": 20.0, "size_z": 20.0, "exhaustiveness": 4})";
+    stream.close();
+
+    // estimates of a previous run are replaced
+    std::filesystem::create_directories(output);
+    stream.open(output / "estimates.txt");
+    stream() << "wu_00000001 1 1" << std::endl;
+    stream.close();
+
+    generator_options options;
+    options.template_config = input / "template.json";
+    options.output = output;
+    options.batch_size = 2;
+    options.threads = 2;
+    options.estimate = true;
+
+    workunit_generator generator(options);
+    ASSERT_TRUE(generator.prepare());
+
+    std::string sha256;
+    ASSERT_TRUE(hash_helper::sha256(input / "1iep_receptor.pdbqt", sha256));
+    ASSERT_EQ(1, generator.get_template().shared.size());
+    EXPECT_STREQ(sha256.c_str(), generator.get_template().shared.at("1iep_receptor.pdbqt").c_str());
+    EXPECT_TRUE(exists(output / "shared" / "1iep_receptor.pdbqt"));
+
+    size_t next = 0;
+    uint64_t workunits = 0;
+    ASSERT_TRUE(generator.run([&](std::filesystem::path& ligand) {
+        if (next == ligands.size()) {
+            return false;
+        }
+        ligand = ligands[next++];
+        return true;
+    }, workunits));
+    EXPECT_EQ(2, workunits);
+
+    size_t packed = 0;
+    for (uint64_t index = 1; index <= workunits; ++index) {
+        const zip_reader reader(generator.workunit_path(index));
+        ASSERT_TRUE(reader.is_open());
+        EXPECT_FALSE(reader.contains("1iep_receptor.pdbqt"));
+
+        const auto& json_name = generator.workunit_path(index).replace_extension(".json").filename().string();
+        std::string json;
+        ASSERT_TRUE(reader.read(json_name, json));
+        config config;
+        ASSERT_TRUE(config.load(std::istringstream(json), output));
+        EXPECT_EQ(1, config.shared.size());
+        for (const auto& b : config.batch) {
+            EXPECT_TRUE(reader.contains(std::filesystem::path(b).filename().string()));
+        }
+        packed += config.batch.size();
+    }
+    EXPECT_EQ(ligands.size(), packed);
+    EXPECT_FALSE(exists(generator.workunit_path(3)));
+
+    std::ifstream estimates(output / "estimates.txt");
+    std::vector<std::string> estimated;
+    std::string name;
+    double fpops;
+    uint64_t memory;
+    while (estimates >> name >> fpops >> memory) {
+        EXPECT_GT(fpops, .0);
+        EXPECT_GT(memory, 0);
+        estimated.push_back(name);
+    }
+    std::sort(estimated.begin(), estimated.end());
+    EXPECT_EQ(std::vector<std::string>({ "wu_00000001", "wu_00000002" }), estimated);
+}
@@ -0,0 +1,162 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "zip_helper/zip-create.h"
+#include "zip_helper/zip-extract.h"
+#include "zip_helper/zip-reader.h"
+#include "zip_helper/zip-writer.h"
+#include "dummy-ofstream.h"
+
+class Zip_UnitTests : public ::testing::Test {};
+
+TEST_F(Zip_UnitTests, ReadEntriesWithoutExtraction) {
+    const auto& zip_file_path = std::filesystem::current_path() / "dummy.zip";
+    std::filesystem::remove(zip_file_path);
+
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy1.pdbqt");
+    create_dummy_file(dummy, "dummy2.json");
+
+    ASSERT_TRUE(zip_create::create(zip_file_path, {
+        std::filesystem::current_path() / "dummy1.pdbqt",
+        std::filesystem::current_path() / "dummy2.json"
+    }));
+
+    {
+        const zip_reader reader(zip_file_path);
+        ASSERT_TRUE(reader.is_open());
+        EXPECT_EQ(2, reader.entries().size());
+        EXPECT_TRUE(reader.contains("dummy1.pdbqt"));
+        EXPECT_TRUE(reader.contains("dummy2.json"));
+        EXPECT_FALSE(reader.contains("dummy3.pdbqt"));
+
+        std::string content;
+        ASSERT_TRUE(reader.read("dummy1.pdbqt", content));
+        EXPECT_STREQ("Dummy\n", content.c_str());
+        EXPECT_FALSE(reader.read("dummy3.pdbqt", content));
+    }
+
+    std::filesystem::remove(zip_file_path);
+}
+
+TEST_F(Zip_UnitTests, ExtractInParallel) {
+    const auto& zip_file_path = std::filesystem::current_path() / "dummy.zip";
+    const auto& target = std::filesystem::current_path() / "dummy_extract";
+    std::filesystem::remove(zip_file_path);
+    std::filesystem::remove_all(target);
+
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy1.pdbqt");
+    create_dummy_file(dummy, "dummy2.pdbqt");
+    create_dummy_file(dummy, "dummy3.json");
+
+    ASSERT_TRUE(zip_create::create(zip_file_path, {
+        std::filesystem::current_path() / "dummy1.pdbqt",
+        std::filesystem::current_path() / "dummy2.pdbqt",
+        std::filesystem::current_path() / "dummy3.json"
+    }));
+
+    create_directories(target);
+    ASSERT_TRUE(zip_extract::extract(zip_file_path, target, [](const auto& name) {
+        return std::filesystem::path(name).extension() == ".pdbqt";
+    }, 2));
+
+    EXPECT_TRUE(exists(target / "dummy1.pdbqt"));
+    EXPECT_TRUE(exists(target / "dummy2.pdbqt"));
+    EXPECT_FALSE(exists(target / "dummy3.json"));
+    EXPECT_EQ(6, std::filesystem::file_size(target / "dummy1.pdbqt"));
+
+    std::filesystem::remove(zip_file_path);
+    std::filesystem::remove_all(target);
+}
+
+TEST_F(Zip_UnitTests, CreateWithCompressionInParallel) {
+    const auto& zip_file_path = std::filesystem::current_path() / "dummy.zip";
+    std::filesystem::remove(zip_file_path);
+
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy1.pdbqt");
+    create_dummy_file(dummy, "dummy2.map");
+    create_dummy_file(dummy, "dummy3.json");
+
+    const std::map<std::string, zip_compression> compression{
+        { "pdbqt", { compression_method::deflate, 9 } },
+        { "map", { compression_method::store, 0 } },
+        { "*", { compression_method::zstd, 3 } }
+    };
+
+    ASSERT_TRUE(zip_create::create(zip_file_path, {
+        std::filesystem::current_path() / "dummy1.pdbqt",
+        std::filesystem::current_path() / "dummy2.map",
+        std::filesystem::current_path() / "dummy3.json"
+    }, compression, 2));
+
+    {
+        const zip_reader reader(zip_file_path);
+        ASSERT_TRUE(reader.is_open());
+        EXPECT_EQ(3, reader.entries().size());
+
+        for (const auto& name : { "dummy1.pdbqt", "dummy2.map", "dummy3.json" }) {
+            std::string content;
+            ASSERT_TRUE(reader.read(name, content));
+            EXPECT_STREQ("Dummy\n", content.c_str());
+        }
+    }
+
+    std::filesystem::remove(zip_file_path);
+}
+
+TEST_F(Zip_UnitTests, WriteEntriesFromMemory) {
+    const auto& zip_file_path = std::filesystem::current_path() / "dummy.zip";
+    std::filesystem::remove(zip_file_path);
+
+    dummy_ofstream dummy;
+    create_dummy_file(dummy, "dummy1.map");
+
+    for (const auto threads : { 1, 2 }) {
+        {
+            zip_writer writer(zip_file_path, {}, threads);
+            ASSERT_TRUE(writer.is_open());
+            ASSERT_TRUE(writer.add("out1.pdbqt", "MODEL 1\nENDMDL\n"));
+            ASSERT_TRUE(writer.add_file(std::filesystem::current_path() / "dummy1.map"));
+            ASSERT_TRUE(writer.add("out2.pdbqt", std::string(100000, 'A')));
+            EXPECT_FALSE(writer.add_file(std::filesystem::current_path() / "dummy2.map"));
+            ASSERT_TRUE(writer.close());
+            EXPECT_FALSE(writer.add("out3.pdbqt", ""));
+            EXPECT_FALSE(exists(std::filesystem::path(zip_file_path.string() + ".entries.tmp")));
+        }
+
+        {
+            const zip_reader reader(zip_file_path);
+            ASSERT_TRUE(reader.is_open());
+            ASSERT_EQ(3, reader.entries().size());
+            EXPECT_STREQ("out1.pdbqt", reader.entries()[0].c_str());
+            EXPECT_STREQ("dummy1.map", reader.entries()[1].c_str());
+            EXPECT_STREQ("out2.pdbqt", reader.entries()[2].c_str());
+
+            std::string content;
+            ASSERT_TRUE(reader.read("out1.pdbqt", content));
+            EXPECT_STREQ("MODEL 1\nENDMDL\n", content.c_str());
+            ASSERT_TRUE(reader.read("out2.pdbqt", content));
+            EXPECT_EQ(std::string(100000, 'A'), content);
+        }
+
+        std::filesystem::remove(zip_file_path);
+    }
+}
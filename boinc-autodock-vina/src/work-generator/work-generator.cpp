@@ -0,0 +1,143 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "workunit-generator.h"
+
+inline void help() {
+    std::cerr << "Usage:" << std::endl;
+    std::cerr << "work-generator [--threads N] [--batch-size N] [--prefix name] [--estimate flops] [--calibrate samples] config.json ligands output" << std::endl;
+    std::cerr << "ligands is a directory with PDBQT files, a text file with one ligand path per line or - to read the paths from standard input" << std::endl;
+}
+
+inline bool parse_count(const char* str, uint64_t& value) {
+    char* end = nullptr;
+    value = std::strtoull(str, &end, 10);
+    return end != str && *end == '\0' && value > 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        generator_options options;
+        uint64_t threads = std::max(1u, std::thread::hardware_concurrency());
+        uint64_t batch_size = options.batch_size;
+        std::vector<std::string> paths;
+        for (auto i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                if (!parse_count(argv[++i], threads)) {
+                    std::cerr << "Wrong number of threads: " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else if (std::strcmp(argv[i], "--batch-size") == 0 && i + 1 < argc) {
+                if (!parse_count(argv[++i], batch_size)) {
+                    std::cerr << "Wrong batch size: " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else if (std::strcmp(argv[i], "--prefix") == 0 && i + 1 < argc) {
+                options.prefix = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--estimate") == 0 && i + 1 < argc) {
+                char* end = nullptr;
+                options.flops = std::strtod(argv[++i], &end);
+                if (end == argv[i] || *end != '\0' || options.flops <= .0) {
+                    std::cerr << "Wrong FLOPS value: " << argv[i] << std::endl;
+                    return 1;
+                }
+                options.estimate = true;
+            }
+            else if (std::strcmp(argv[i], "--calibrate") == 0 && i + 1 < argc) {
+                if (!estimator::calibrate(argv[++i], options.model)) {
+                    std::cerr << "Failed to calibrate cost model" << std::endl;
+                    return 1;
+                }
+            }
+            else {
+                paths.emplace_back(argv[i]);
+            }
+        }
+
+        if (paths.size() != 3) {
+            help();
+            return 1;
+        }
+
+        options.template_config = std::filesystem::absolute(paths[0]);
+        options.output = paths[2];
+        options.batch_size = static_cast<size_t>(batch_size);
+        options.threads = static_cast<int>(threads);
+
+        workunit_generator generator(options);
+        if (!generator.prepare()) {
+            return 1;
+        }
+
+        uint64_t workunits = 0;
+        auto result = false;
+        const auto& ligands = std::filesystem::path(paths[1]);
+        if (paths[1] != "-" && is_directory(ligands)) {
+            auto it = std::filesystem::directory_iterator(ligands);
+            result = generator.run([&it](std::filesystem::path& ligand) {
+                for (; it != std::filesystem::directory_iterator(); ++it) {
+                    if (it->is_regular_file() && it->path().extension() == ".pdbqt") {
+                        ligand = it->path();
+                        ++it;
+                        return true;
+                    }
+                }
+                return false;
+            }, workunits);
+        }
+        else {
+            std::ifstream file;
+            if (paths[1] != "-") {
+                file.open(ligands);
+                if (!file) {
+                    std::cerr << "Failed to open <" << ligands.filename().string() << ">" << std::endl;
+                    return 1;
+                }
+            }
+            auto& stream = paths[1] == "-" ? std::cin : file;
+            const auto& base = paths[1] == "-" ? std::filesystem::current_path() : std::filesystem::absolute(ligands).parent_path();
+            result = generator.run([&stream, &base](std::filesystem::path& ligand) {
+                std::string line;
+                while (std::getline(stream, line)) {
+                    if (!line.empty()) {
+                        ligand = base / line;
+                        return true;
+                    }
+                }
+                return false;
+            }, workunits);
+        }
+
+        std::cout << "Created " << workunits << " workunits" << std::endl;
+        return result ? 0 : 1;
+    }
+    catch (std::exception& ex) {
+        std::cerr << "Exception was thrown while running work-generator: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,223 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "hash_helper/hash-helper.h"
+#include "zip_helper/zip-create.h"
+
+#include "workunit-generator.h"
+
+workunit_generator::workunit_generator(generator_options options) : options(std::move(options)) {
+    this->options.batch_size = std::max<size_t>(1, this->options.batch_size);
+}
+
+bool workunit_generator::prepare() {
+    if (!workunit_template.load(options.template_config)) {
+        std::cerr << "Failed to load template config <" << options.template_config.filename().string() << ">" << std::endl;
+        return false;
+    }
+
+    workunit_template.ligands.clear();
+    workunit_template.batch.clear();
+    const auto& working_directory = options.template_config.parent_path();
+    if (workunit_template.dir.empty() && workunit_template.batch_out.empty()) {
+        workunit_template.batch_out = (working_directory / "results.pdbqt").string();
+    }
+
+    auto check = workunit_template;
+    check.batch.push_back((working_directory / "ligand.pdbqt").string());
+    if (!check.validate([](const auto&) { return true; })) {
+        std::cerr << "Template config is not valid for batch workunits" << std::endl;
+        return false;
+    }
+
+    const auto& shared_path = options.output / "shared";
+    if (!exists(shared_path)) {
+        create_directories(shared_path);
+    }
+
+    for (const auto& file : workunit_template.get_files()) {
+        const auto& path = std::filesystem::path(file);
+        const auto& name = path.filename().string();
+        std::string sha256;
+        if (!hash_helper::sha256(path, sha256)) {
+            std::cerr << "Failed to calculate SHA-256 of <" << name << ">" << std::endl;
+            return false;
+        }
+        if (workunit_template.shared.count(name) != 0 && workunit_template.shared[name] != sha256) {
+            std::cerr << "Different shared files have the same name <" << name << ">" << std::endl;
+            return false;
+        }
+        workunit_template.shared[name] = sha256;
+
+        // a file already packed for the same receptor is kept
+        std::string packed_sha256;
+        const auto& target = shared_path / name;
+        if (exists(target) && hash_helper::sha256(target, packed_sha256) && packed_sha256 == sha256) {
+            continue;
+        }
+        std::filesystem::copy_file(path, target, std::filesystem::copy_options::overwrite_existing);
+    }
+
+    // workunits are numbered from the first one again, so estimates of a previous run are dropped
+    if (options.estimate && !std::ofstream(options.output / "estimates.txt", std::ios::trunc)) {
+        std::cerr << "Failed to create <estimates.txt>" << std::endl;
+        return false;
+    }
+
+    // receptors are the same for all workunits, so they are read once
+    if (options.estimate) {
+        auto receptors = workunit_template.receptors;
+        receptors.push_back(workunit_template.receptor);
+        receptors.push_back(workunit_template.flex);
+        for (const auto& file : receptors) {
+            if (file.empty()) {
+                continue;
+            }
+            std::ifstream stream(file, std::ios::binary);
+            std::ostringstream content;
+            content << stream.rdbuf();
+            receptor_atoms += estimator::count_atoms(content.str());
+        }
+    }
+
+    return true;
+}
+
+bool workunit_generator::write_estimate(const std::string& workunit, const config& config) const {
+    std::vector<ligand_features> ligands;
+    for (const auto& file : config.batch) {
+        std::ifstream stream(file, std::ios::binary);
+        std::ostringstream content;
+        content << stream.rdbuf();
+        ligand_features features;
+        if (!stream || !estimator::read_ligand(content.str(), features)) {
+            std::cerr << "Failed to read ligand <" << std::filesystem::path(file).filename().string() << ">" << std::endl;
+            return false;
+        }
+        ligands.push_back(features);
+    }
+
+    const auto& estimate = estimator(options.model).estimate(config, receptor_atoms, ligands);
+
+    std::lock_guard lock(estimates_mutex);
+    std::ofstream estimates(options.output / "estimates.txt", std::ios::app);
+    estimates << workunit << " " << std::fixed << std::setprecision(0) << estimate.fpops(options.flops) << " " << estimate.peak_memory << std::endl;
+    return static_cast<bool>(estimates);
+}
+
+std::filesystem::path workunit_generator::workunit_path(const uint64_t& index) const {
+    std::ostringstream name;
+    name << options.prefix << "_" << std::setw(8) << std::setfill('0') << index << ".zip";
+    return options.output / name.str();
+}
+
+const config& workunit_generator::get_template() const {
+    return workunit_template;
+}
+
+bool workunit_generator::create_workunit(const uint64_t& index, const std::vector<std::filesystem::path>& ligands) const {
+    const auto& zip_path = workunit_path(index);
+    auto config_path = zip_path;
+    config_path.replace_extension(".json");
+
+    auto workunit = workunit_template;
+    std::set<std::string> names;
+    std::vector<std::filesystem::path> files{ config_path };
+    for (const auto& ligand : ligands) {
+        // ligands are packed flat into the archive
+        if (!names.insert(ligand.filename().string()).second) {
+            std::cerr << "Ligand <" << ligand.filename().string() << "> is used twice in <" << zip_path.filename().string() << ">" << std::endl;
+            return false;
+        }
+        workunit.batch.push_back(ligand.string());
+        files.push_back(ligand);
+    }
+
+    if (!workunit.save(config_path)) {
+        return false;
+    }
+
+    // archive appears under its final name only when complete
+    auto temporary_path = zip_path;
+    temporary_path += ".tmp";
+    const auto created = zip_create::create(temporary_path, files);
+    std::filesystem::remove(config_path);
+    if (!created) {
+        std::cerr << "Failed to create <" << zip_path.filename().string() << ">" << std::endl;
+        std::filesystem::remove(temporary_path);
+        return false;
+    }
+    std::filesystem::rename(temporary_path, zip_path);
+
+    return !options.estimate || write_estimate(zip_path.stem().string(), workunit);
+}
+
+bool workunit_generator::run(const std::function<bool(std::filesystem::path&)>& next_ligand, uint64_t& workunits) {
+    std::mutex next_mutex;
+    std::atomic failed(false);
+    uint64_t next_index = 0;
+    auto finished = false;
+
+    const auto& worker = [&]() {
+        while (!failed) {
+            uint64_t index;
+            std::vector<std::filesystem::path> ligands;
+            {
+                std::lock_guard lock(next_mutex);
+                std::filesystem::path ligand;
+                while (!finished && ligands.size() < options.batch_size) {
+                    if (next_ligand(ligand)) {
+                        ligands.push_back(ligand);
+                    }
+                    else {
+                        finished = true;
+                    }
+                }
+                if (ligands.empty()) {
+                    return;
+                }
+                index = ++next_index;
+            }
+
+            if (!create_workunit(index, ligands)) {
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto i = 1; i < options.threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    workunits = next_index;
+    return !failed;
+}
@@ -0,0 +1,65 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/estimator.h"
+
+class generator_options {
+public:
+    // receptor or maps, box and docking parameters shared by all workunits
+    std::filesystem::path template_config;
+    // workunit archives are written here, shared files go to its "shared" subdirectory
+    std::filesystem::path output;
+    std::string prefix = "wu";
+    size_t batch_size = 100;
+    int threads = 1;
+    // when set, rsc_fpops_est and peak memory of every workunit are written to "estimates.txt"
+    bool estimate = false;
+    cost_model model;
+    // FLOPS of the host the model was calibrated on
+    double flops = 1e9;
+};
+
+// Groups ligands into batch workunits. Receptor, flex and maps files of the template are
+// shared between workunits: they are copied once and referenced by their SHA-256 hash.
+class workunit_generator final {
+public:
+    explicit workunit_generator(generator_options options);
+
+    [[nodiscard]] bool prepare();
+    [[nodiscard]] bool create_workunit(const uint64_t& index, const std::vector<std::filesystem::path>& ligands) const;
+    // next_ligand returns false when there are no more ligands
+    [[nodiscard]] bool run(const std::function<bool(std::filesystem::path&)>& next_ligand, uint64_t& workunits);
+    [[nodiscard]] std::filesystem::path workunit_path(const uint64_t& index) const;
+    [[nodiscard]] const config& get_template() const;
+private:
+    [[nodiscard]] bool write_estimate(const std::string& workunit, const config& config) const;
+
+    generator_options options;
+    config workunit_template;
+    uint64_t receptor_atoms = 0;
+    mutable std::mutex estimates_mutex;
+};
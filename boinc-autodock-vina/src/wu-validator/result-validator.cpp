@@ -0,0 +1,427 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <jsoncons/json.hpp>
+
+#include "zip_helper/zip-reader.h"
+
+#include "result-validator.h"
+
+namespace {
+// derived from the input only
+const std::vector<std::string> skipped_extensions{ ".map", ".fld", ".xyz", ".gpf" };
+// columns of CSV files and members of JSON files that differ between hosts: timings, runs saved by early stop,
+// the best target of near ties and contacts that follow the poses compared by RMSD
+const std::set<std::string> skipped_fields{ "wall_time", "cpu_time", "search_runs", "saved_runs", "best_target", "hydrogen_bonds", "hydrophobic", "pi" };
+
+bool is_record(const std::string& line, const char* record) {
+    return line.compare(0, std::char_traits<char>::length(record), record) == 0;
+}
+
+bool parse_value(const std::string& field, float& value) {
+    char* end = nullptr;
+    value = std::strtof(field.c_str(), &end);
+    return end != field.c_str();
+}
+
+bool parse_number(const std::string& field, double& value) {
+    char* end = nullptr;
+    value = std::strtod(field.c_str(), &end);
+    return !field.empty() && end == field.c_str() + field.size();
+}
+
+// fields could be quoted, quotes inside them are doubled
+bool split_csv(const std::string& line, std::vector<std::string>& fields) {
+    fields.assign(1, std::string());
+    auto quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const auto c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                fields.back() += c;
+            }
+            else if (i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += c;
+                ++i;
+            }
+            else {
+                quoted = false;
+            }
+        }
+        else if (c == '"') {
+            quoted = true;
+        }
+        else if (c == ',') {
+            fields.emplace_back();
+        }
+        else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return !quoted;
+}
+
+// numbers are compared within the energy tolerance, lists of them separated by ';' item by item
+bool compare_field(const std::string& field1, const std::string& field2, const double& tolerance) {
+    std::istringstream stream1(field1);
+    std::istringstream stream2(field2);
+    std::string item1;
+    std::string item2;
+    while (std::getline(stream1, item1, ';')) {
+        if (!std::getline(stream2, item2, ';')) {
+            return false;
+        }
+        double value1;
+        double value2;
+        if (parse_number(item1, value1) && parse_number(item2, value2) ? std::abs(value1 - value2) > tolerance : item1 != item2) {
+            return false;
+        }
+    }
+    return !std::getline(stream2, item2, ';');
+}
+
+bool compare_values(const jsoncons::json& value1, const jsoncons::json& value2, const std::string& path, const validation_tolerance& tolerance) {
+    if (value1.is_number() && value2.is_number()) {
+        if (std::abs(value1.as<double>() - value2.as<double>()) > tolerance.energy) {
+            std::cerr << "Value of <" << path << "> differs: " << value1.as<double>() << " and " << value2.as<double>() << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if (value1.is_object() && value2.is_object()) {
+        if (value1.size() != value2.size()) {
+            std::cerr << "Different members of <" << path << ">" << std::endl;
+            return false;
+        }
+        for (const auto& member : value1.object_range()) {
+            if (skipped_fields.find(member.key()) != skipped_fields.cend()) {
+                continue;
+            }
+            if (!value2.contains(member.key())) {
+                std::cerr << "Different members of <" << path << ">" << std::endl;
+                return false;
+            }
+            if (!compare_values(member.value(), value2[member.key()], path + "." + member.key(), tolerance)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (value1.is_array() && value2.is_array()) {
+        if (value1.size() != value2.size()) {
+            std::cerr << "Different number of items in <" << path << ">: " << value1.size() << " and " << value2.size() << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < value1.size(); ++i) {
+            if (!compare_values(value1[i], value2[i], path + "[" + std::to_string(i) + "]", tolerance)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (value1 != value2) {
+        std::cerr << "Value of <" << path << "> differs" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double rmsd(const std::vector<float>& coordinates1, const std::vector<float>& coordinates2) {
+    if (coordinates1.empty()) {
+        return .0;
+    }
+    double sum = .0;
+    for (size_t i = 0; i < coordinates1.size(); ++i) {
+        const auto d = static_cast<double>(coordinates1[i]) - static_cast<double>(coordinates2[i]);
+        sum += d * d;
+    }
+    return std::sqrt(sum / static_cast<double>(coordinates1.size() / 3));
+}
+}
+
+bool result_validator::read_poses(const std::string& pdbqt, std::vector<pose_result>& poses) {
+    std::istringstream stream(pdbqt);
+    std::string line;
+    auto in_model = false;
+    while (std::getline(stream, line)) {
+        if (is_record(line, "MODEL")) {
+            poses.emplace_back();
+            in_model = true;
+        }
+        else if (is_record(line, "ENDMDL")) {
+            in_model = false;
+        }
+        else if (in_model && is_record(line, "REMARK VINA RESULT:")) {
+            float affinity;
+            if (!parse_value(line.substr(std::char_traits<char>::length("REMARK VINA RESULT:")), affinity)) {
+                std::cerr << "Wrong result record: " << line << std::endl;
+                return false;
+            }
+            poses.back().energies.push_back(affinity);
+        }
+        else if (in_model && (is_record(line, "ATOM") || is_record(line, "HETATM"))) {
+            float x, y, z;
+            if (line.size() < 54 ||
+                !parse_value(line.substr(30, 8), x) ||
+                !parse_value(line.substr(38, 8), y) ||
+                !parse_value(line.substr(46, 8), z)) {
+                std::cerr << "Wrong atom record: " << line << std::endl;
+                return false;
+            }
+            poses.back().coordinates.insert(poses.back().coordinates.end(), { x, y, z });
+        }
+    }
+    return true;
+}
+
+// poses with nearly equal energies could be ordered differently on other hosts,
+// so every pose is paired with the closest unpaired pose of the other result
+bool result_validator::compare_poses(const std::vector<pose_result>& poses1, const std::vector<pose_result>& poses2, const validation_tolerance& tolerance) {
+    if (poses1.size() != poses2.size()) {
+        std::cerr << "Different number of poses: " << poses1.size() << " and " << poses2.size() << std::endl;
+        return false;
+    }
+
+    std::vector<bool> paired(poses2.size(), false);
+    for (size_t i = 0; i < poses1.size(); ++i) {
+        const auto& pose1 = poses1[i];
+        auto best = poses2.size();
+        auto best_rmsd = .0;
+        for (size_t j = 0; j < poses2.size(); ++j) {
+            const auto& pose2 = poses2[j];
+            if (paired[j] || pose1.energies.size() != pose2.energies.size() || pose1.coordinates.size() != pose2.coordinates.size()) {
+                continue;
+            }
+            const auto& same_energy = [&tolerance](const float& energy1, const float& energy2) {
+                return std::abs(energy1 - energy2) <= tolerance.energy;
+            };
+            if (!std::equal(pose1.energies.cbegin(), pose1.energies.cend(), pose2.energies.cbegin(), same_energy)) {
+                continue;
+            }
+            if (const auto& value = rmsd(pose1.coordinates, pose2.coordinates); value <= tolerance.rmsd && (best == poses2.size() || value < best_rmsd)) {
+                best = j;
+                best_rmsd = value;
+            }
+        }
+        if (best == poses2.size()) {
+            std::cerr << "No pose matches pose " << i + 1 << " within tolerance" << std::endl;
+            return false;
+        }
+        paired[best] = true;
+    }
+
+    return true;
+}
+
+bool result_validator::compare_csv(const std::string& csv1, const std::string& csv2, const validation_tolerance& tolerance) {
+    std::istringstream stream1(csv1);
+    std::istringstream stream2(csv2);
+    std::string line1;
+    std::string line2;
+    std::vector<std::string> header;
+    std::vector<std::string> fields1;
+    std::vector<std::string> fields2;
+    for (size_t row = 0; std::getline(stream1, line1); ++row) {
+        if (!std::getline(stream2, line2)) {
+            std::cerr << "Different number of rows: " << row << " and more" << std::endl;
+            return false;
+        }
+        if (!split_csv(line1, fields1) || !split_csv(line2, fields2)) {
+            std::cerr << "Wrong CSV row " << row + 1 << std::endl;
+            return false;
+        }
+        if (row == 0) {
+            if (fields1 != fields2) {
+                std::cerr << "Different columns: " << line1 << " and " << line2 << std::endl;
+                return false;
+            }
+            header = fields1;
+            continue;
+        }
+        if (fields1.size() != header.size() || fields2.size() != header.size()) {
+            std::cerr << "Wrong number of fields in row " << row + 1 << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < header.size(); ++i) {
+            if (skipped_fields.find(header[i]) == skipped_fields.cend() && !compare_field(fields1[i], fields2[i], tolerance.energy)) {
+                std::cerr << "Value of <" << header[i] << "> in row " << row + 1 << " differs: " << fields1[i] << " and " << fields2[i] << std::endl;
+                return false;
+            }
+        }
+    }
+    if (std::getline(stream2, line2)) {
+        std::cerr << "Different number of rows" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool result_validator::compare_json(const std::string& json1, const std::string& json2, const validation_tolerance& tolerance) {
+    try {
+        return compare_values(jsoncons::json::parse(json1), jsoncons::json::parse(json2), "$", tolerance);
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "Failed to parse JSON: " << ex.what() << std::endl;
+        return false;
+    }
+}
+
+bool result_validator::compare_entry(const std::string& name, const std::string& content1, const std::string& content2, const validation_tolerance& tolerance) {
+    const auto& extension = std::filesystem::path(name).extension().string();
+    if (std::find(skipped_extensions.cbegin(), skipped_extensions.cend(), extension) != skipped_extensions.cend()) {
+        return true;
+    }
+
+    // sites docked in parallel list their outputs in any order
+    if (name == results_targets::file) {
+        std::map<std::string, std::string> targets1;
+        std::map<std::string, std::string> targets2;
+        if (!results_targets::read(content1, targets1) || !results_targets::read(content2, targets2)) {
+            std::cerr << "Failed to read <" << name << ">" << std::endl;
+            return false;
+        }
+        if (targets1 != targets2) {
+            std::cerr << "Different targets in <" << name << ">" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // summaries, scores, ensemble scores and interactions
+    if (extension == ".csv" || extension == ".json") {
+        if (!(extension == ".csv" ? compare_csv(content1, content2, tolerance) : compare_json(content1, content2, tolerance))) {
+            std::cerr << "Values in <" << name << "> differ" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (extension == ".bin") {
+        std::vector<ligand_result> results1;
+        std::vector<ligand_result> results2;
+        if (!results_file::read(content1, results1) || !results_file::read(content2, results2)) {
+            std::cerr << "Failed to read <" << name << ">" << std::endl;
+            return false;
+        }
+        if (results1.size() != results2.size()) {
+            std::cerr << "Different number of ligands in <" << name << ">" << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < results1.size(); ++i) {
+            if (results1[i].name != results2[i].name || results1[i].input_crc != results2[i].input_crc) {
+                std::cerr << "Different ligands in <" << name << ">: " << results1[i].name << " and " << results2[i].name << std::endl;
+                return false;
+            }
+            if (!compare_poses(results1[i].poses, results2[i].poses, tolerance)) {
+                std::cerr << "Results of <" << results1[i].name << "> in <" << name << "> differ" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (extension == ".idx") {
+        std::vector<stream_entry> entries1;
+        std::vector<stream_entry> entries2;
+        if (!results_stream::read_index(content1, entries1) || !results_stream::read_index(content2, entries2)) {
+            std::cerr << "Failed to read <" << name << ">" << std::endl;
+            return false;
+        }
+        const auto& same_name = [](const auto& a, const auto& b) { return a.name == b.name; };
+        if (!std::equal(entries1.cbegin(), entries1.cend(), entries2.cbegin(), entries2.cend(), same_name)) {
+            std::cerr << "Different ligands in <" << name << ">" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // poses of one ligand or a batch stream of them
+    std::vector<pose_result> poses1;
+    std::vector<pose_result> poses2;
+    if (!read_poses(content1, poses1) || !read_poses(content2, poses2)) {
+        std::cerr << "Failed to read poses from <" << name << ">" << std::endl;
+        return false;
+    }
+    if (!compare_poses(poses1, poses2, tolerance)) {
+        std::cerr << "Poses in <" << name << "> differ" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool result_validator::check(const std::filesystem::path& result) {
+    const zip_reader reader(result);
+    if (!reader.is_open()) {
+        std::cerr << "Failed to open result archive" << std::endl;
+        return false;
+    }
+
+    // every entry is parsed by comparing it with itself
+    for (const auto& entry : reader.entries()) {
+        std::string content;
+        if (!reader.read(entry, content)) {
+            std::cerr << "Failed to read <" << entry << "> from result archive" << std::endl;
+            return false;
+        }
+        if (!compare_entry(entry, content, content, {})) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool result_validator::validate(const std::filesystem::path& result1, const std::filesystem::path& result2, const validation_tolerance& tolerance) {
+    const zip_reader reader1(result1);
+    const zip_reader reader2(result2);
+    if (!reader1.is_open() || !reader2.is_open()) {
+        std::cerr << "Failed to open result archives" << std::endl;
+        return false;
+    }
+
+    auto entries1 = reader1.entries();
+    auto entries2 = reader2.entries();
+    std::sort(entries1.begin(), entries1.end());
+    std::sort(entries2.begin(), entries2.end());
+    if (entries1 != entries2) {
+        std::cerr << "Result archives have different files" << std::endl;
+        return false;
+    }
+
+    for (const auto& entry : entries1) {
+        std::string content1;
+        std::string content2;
+        if (!reader1.read(entry, content1) || !reader2.read(entry, content2)) {
+            std::cerr << "Failed to read <" << entry << "> from result archives" << std::endl;
+            return false;
+        }
+        if (!compare_entry(entry, content1, content2, tolerance)) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,46 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "common/results.h"
+
+class validation_tolerance {
+public:
+    // kcal/mol
+    double energy = 0.1;
+    // angstrom
+    double rmsd = 0.5;
+};
+
+// Compares two result archives of the same workunit: both should have the same entries,
+// poses are compared by energy and RMSD within tolerance, numbers of CSV and JSON files within the energy tolerance.
+class result_validator final {
+public:
+    [[nodiscard]] static bool read_poses(const std::string& pdbqt, std::vector<pose_result>& poses);
+    [[nodiscard]] static bool compare_poses(const std::vector<pose_result>& poses1, const std::vector<pose_result>& poses2, const validation_tolerance& tolerance);
+    [[nodiscard]] static bool compare_csv(const std::string& csv1, const std::string& csv2, const validation_tolerance& tolerance);
+    [[nodiscard]] static bool compare_json(const std::string& json1, const std::string& json2, const validation_tolerance& tolerance);
+    [[nodiscard]] static bool compare_entry(const std::string& name, const std::string& content1, const std::string& content2, const validation_tolerance& tolerance);
+    // checks that every entry of a single result archive could be read
+    [[nodiscard]] static bool check(const std::filesystem::path& result);
+    [[nodiscard]] static bool validate(const std::filesystem::path& result1, const std::filesystem::path& result2, const validation_tolerance& tolerance);
+};
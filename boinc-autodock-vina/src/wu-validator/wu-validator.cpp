@@ -0,0 +1,74 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "result-validator.h"
+
+inline void help() {
+    std::cerr << "Usage:" << std::endl;
+    std::cerr << "wu-validator [--energy-tolerance kcal/mol] [--rmsd-tolerance angstrom] result1.zip result2.zip" << std::endl;
+    std::cerr << "wu-validator result.zip" << std::endl;
+}
+
+inline bool parse_tolerance(const char* str, double& value) {
+    char* end = nullptr;
+    value = std::strtod(str, &end);
+    return end != str && *end == '\0' && value >= .0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        validation_tolerance tolerance;
+        std::vector<std::string> results;
+        for (auto i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--energy-tolerance") == 0 && i + 1 < argc) {
+                if (!parse_tolerance(argv[++i], tolerance.energy)) {
+                    std::cerr << "Wrong energy tolerance: " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else if (std::strcmp(argv[i], "--rmsd-tolerance") == 0 && i + 1 < argc) {
+                if (!parse_tolerance(argv[++i], tolerance.rmsd)) {
+                    std::cerr << "Wrong RMSD tolerance: " << argv[i] << std::endl;
+                    return 1;
+                }
+            }
+            else {
+                results.emplace_back(argv[i]);
+            }
+        }
+
+        if (results.size() == 1) {
+            return result_validator::check(results[0]) ? 0 : 1;
+        }
+        if (results.size() != 2) {
+            help();
+            return 1;
+        }
+
+        return result_validator::validate(results[0], results[1], tolerance) ? 0 : 1;
+    }
+    catch (std::exception& ex) {
+        std::cerr << "Exception was thrown while running wu-validator: " << ex.what() << std::endl;
+        return 1;
+    }
+}
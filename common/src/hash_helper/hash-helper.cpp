@@ -0,0 +1,97 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "hash-helper.h"
+
+#include <array>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <openssl/evp.h>
+
+template <typename T>
+using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
+
+constexpr std::array<uint32_t, 256> make_crc32_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        auto c = i;
+        for (auto k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr auto crc32_table = make_crc32_table();
+
+uint32_t hash_helper::crc32(uint32_t crc, const void* data, size_t size) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    auto c = crc ^ 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        c = crc32_table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+bool hash_helper::sha256(const std::filesystem::path& file, std::string& hash) {
+    constexpr size_t buffer_size = 64 * 1024;
+    constexpr auto hex = "0123456789abcdef";
+
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Failed to open <" << file.filename().string() << "> for hashing" << std::endl;
+        return false;
+    }
+
+    const deleted_unique_ptr<EVP_MD_CTX> context(EVP_MD_CTX_new(), [](auto* c) {
+        EVP_MD_CTX_free(c);
+    });
+    if (!context || EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr) != 1) {
+        return false;
+    }
+
+    std::vector<char> buffer(buffer_size);
+    while (stream) {
+        stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (stream.gcount() > 0 && EVP_DigestUpdate(context.get(), buffer.data(), static_cast<size_t>(stream.gcount())) != 1) {
+            return false;
+        }
+    }
+    if (stream.bad()) {
+        std::cerr << "Failed to read <" << file.filename().string() << "> for hashing" << std::endl;
+        return false;
+    }
+
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+    unsigned int digest_size = 0;
+    if (EVP_DigestFinal_ex(context.get(), digest.data(), &digest_size) != 1) {
+        return false;
+    }
+
+    hash.clear();
+    for (unsigned int i = 0; i < digest_size; ++i) {
+        hash.push_back(hex[digest[i] >> 4]);
+        hash.push_back(hex[digest[i] & 0x0F]);
+    }
+
+    return true;
+}
@@ -17,41 +17,21 @@
 
 #include "zip-create.h"
 
-#include <functional>
-#include <zip.h>
-#include <iostream>
-
-template <typename T>
-using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
-
 bool zip_create::create(const std::filesystem::path& zip_file, const std::vector<std::filesystem::path>& files) {
-    int error = 0;
-    const deleted_unique_ptr<zip_t> zip(zip_open(zip_file.string().data(), ZIP_CREATE | ZIP_EXCL, &error), [](auto* z) {
-        if (z != nullptr) {
-            zip_close(z);
-        }
-        });
+    return create(zip_file, files, {}, 1);
+}
 
-    if (!zip) {
-        zip_error_t zip_error;
-        zip_error_init_with_code(&zip_error, error);
-        std::cerr << "Failed to create archive <" << zip_file.filename().string() << ">: " << zip_error_strerror(&zip_error) << std::endl;
+bool zip_create::create(const std::filesystem::path& zip_file, const std::vector<std::filesystem::path>& files, const std::map<std::string, zip_compression>& compression, const int& threads) {
+    zip_writer writer(zip_file, compression, threads);
+    if (!writer.is_open()) {
         return false;
     }
 
     for (const auto& file : files) {
-        if (is_regular_file(file)) {
-            const deleted_unique_ptr<zip_source_t> source(zip_source_file(zip.get(), file.string().data(), 0, 0), [](auto*) {});
-            if (!source) {
-                std::cerr << "Failed to open file <" << file.filename().string() << ">: " << zip_strerror(zip.get()) << std::endl;
-            }
-            if (zip_file_add(zip.get(), file.filename().string().data(), source.get(), ZIP_FL_ENC_UTF_8) < 0) {
-                zip_source_free(source.get());
-                std::cerr << "Failed to add file <" << file.filename().string() << "> to archive : " << zip_strerror(zip.get()) << std::endl;
-                return false;
-            }
+        if (is_regular_file(file) && !writer.add_file(file)) {
+            return false;
         }
     }
 
-    return true;
+    return writer.close();
 }
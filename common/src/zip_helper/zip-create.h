@@ -18,9 +18,15 @@
 #pragma once
 
 #include <filesystem>
+#include <map>
+#include <string>
 #include <vector>
 
+#include "zip-writer.h"
+
 class zip_create final {
 public:
     static bool create(const std::filesystem::path& zip_file, const std::vector<std::filesystem::path>& files);
+    // compression is looked up by file extension without the leading dot, "*" matches any other file
+    static bool create(const std::filesystem::path& zip_file, const std::vector<std::filesystem::path>& files, const std::map<std::string, zip_compression>& compression, const int& threads);
 };
@@ -17,53 +17,193 @@
 
 #include "zip-extract.h"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <fstream>
 #include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
 
 #include <zip.h>
 
+#include "hash_helper/hash-helper.h"
+
 template <typename T>
 using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
 
-bool zip_extract::extract(const std::filesystem::path& zip_file, const std::filesystem::path& target) {
+namespace {
+constexpr size_t extract_buffer_size = 64 * 1024;
+
+struct archive_entry {
+    zip_uint64_t index;
+    std::string name;
+    zip_uint64_t size;
+    zip_uint32_t crc;
+};
+
+deleted_unique_ptr<zip_t> open_zip(const std::filesystem::path& zip_file) {
     int error = 0;
-    const deleted_unique_ptr<zip_t> zip(zip_open(zip_file.string().data(), 0, &error), [](auto* z) {
+    return deleted_unique_ptr<zip_t>(zip_open(zip_file.string().data(), ZIP_RDONLY, &error), [](auto* z) {
         if (z != nullptr) {
-            zip_close(z);
+            zip_discard(z);
         }
     });
-    if (!zip) {
+}
+
+bool extract_entry(zip_t* zip, const archive_entry& entry, const std::filesystem::path& target, std::vector<char>& buffer) {
+    const deleted_unique_ptr<struct zip_file> file(zip_fopen_index(zip, entry.index, 0), [](auto* z) {
+        if (z != nullptr) {
+            zip_fclose(z);
+        }
+    });
+    if (!file) {
+        std::cerr << "Failed to open <" << entry.name << "> in archive: " << zip_strerror(zip) << std::endl;
+        return false;
+    }
+
+    const auto name = target / entry.name;
+    std::ofstream stream(name, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Failed to create <" << name.filename().string() << ">" << std::endl;
         return false;
     }
 
-    const auto& entries = zip_get_num_entries(zip.get(), 0);
-    for (zip_int64_t i = 0; i < entries; ++i) {
-        struct zip_stat file_stat {};
-        if (zip_stat_index(zip.get(), i, 0, &file_stat)) {
+    zip_uint64_t total = 0;
+    uint32_t crc = 0;
+    while (true) {
+        const auto read = zip_fread(file.get(), buffer.data(), buffer.size());
+        if (read < 0) {
+            std::cerr << "Failed to read <" << entry.name << "> from archive: " << zip_file_strerror(file.get()) << std::endl;
             return false;
         }
-        if (!(file_stat.valid & ZIP_STAT_NAME)) {
-            continue;
+        if (read == 0) {
+            break;
         }
-        if ((file_stat.name[0] != '\0') && (file_stat.name[strlen(file_stat.name) - 1] == '/')) {
-            continue;
+        crc = hash_helper::crc32(crc, buffer.data(), static_cast<size_t>(read));
+        total += static_cast<zip_uint64_t>(read);
+        if (!stream.write(buffer.data(), read)) {
+            std::cerr << "Failed to write <" << name.filename().string() << ">" << std::endl;
+            return false;
         }
-        const deleted_unique_ptr<struct zip_file> file(zip_fopen_index(zip.get(), i, 0), [](auto* z) {
-            if (z != nullptr) {
-                zip_fclose(z);
+    }
+
+    if (total != entry.size || crc != entry.crc) {
+        std::cerr << "Corrupted <" << entry.name << "> entry in archive" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool is_inside_target(const std::string& entry_name) {
+    const auto& name = std::filesystem::path(entry_name).lexically_normal();
+    return !name.is_absolute() && !name.has_root_path() && (name.empty() || *name.begin() != "..");
+}
+
+bool extract_entries(const std::filesystem::path& zip_file, const std::filesystem::path& target, const std::vector<archive_entry>& entries, const int& threads) {
+    for (const auto& entry : entries) {
+        const auto& parent = (target / entry.name).parent_path();
+        if (!exists(parent)) {
+            create_directories(parent);
+        }
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic failed(false);
+
+    const auto& worker = [&]() {
+        const auto& zip = open_zip(zip_file);
+        if (!zip) {
+            failed = true;
+            return;
+        }
+        std::vector<char> buffer(extract_buffer_size);
+        for (auto i = next++; i < entries.size() && !failed; i = next++) {
+            if (!extract_entry(zip.get(), entries[i], target, buffer)) {
+                failed = true;
             }
-        });
-        std::string buffer;
-        buffer.resize(file_stat.size, '\0');
-        if (zip_fread(file.get(), buffer.data(), file_stat.size) == -1) {
+        }
+    };
+
+    const auto workers_count = std::max<size_t>(1, std::min<size_t>(threads > 0 ? threads : 1, entries.size()));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workers_count; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    return !failed;
+}
+}
+
+bool zip_extract::extract(const std::filesystem::path& zip_file, const std::filesystem::path& target) {
+    return extract(zip_file, target, [](const auto&) { return true; }, 1);
+}
+
+bool zip_extract::extract(const std::filesystem::path& zip_file, const std::filesystem::path& target, const std::function<bool(const std::string&)>& filter, const int& threads) {
+    std::vector<archive_entry> entries;
+    {
+        const auto& zip = open_zip(zip_file);
+        if (!zip) {
             return false;
         }
-        const auto name = target / file_stat.name;
-        if (!std::ofstream(name.string().data()).write(buffer.data(), file_stat.size)) {
+
+        const auto& count = zip_get_num_entries(zip.get(), 0);
+        for (zip_int64_t i = 0; i < count; ++i) {
+            struct zip_stat file_stat {};
+            if (zip_stat_index(zip.get(), i, 0, &file_stat)) {
+                return false;
+            }
+            if (!(file_stat.valid & ZIP_STAT_NAME)) {
+                continue;
+            }
+            if ((file_stat.name[0] != '\0') && (file_stat.name[strlen(file_stat.name) - 1] == '/')) {
+                continue;
+            }
+            if (!filter(file_stat.name)) {
+                continue;
+            }
+            if (!is_inside_target(file_stat.name)) {
+                std::cerr << "Archive entry <" << file_stat.name << "> points outside of target directory" << std::endl;
+                return false;
+            }
+            entries.push_back({ file_stat.index, file_stat.name, file_stat.size, file_stat.crc });
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.size > b.size;
+    });
+
+    return extract_entries(zip_file, target, entries, threads);
+}
+
+bool zip_extract::extract(const std::filesystem::path& zip_file, const std::filesystem::path& target, const std::vector<std::string>& names, const int& threads) {
+    std::vector<archive_entry> entries;
+    {
+        const auto& zip = open_zip(zip_file);
+        if (!zip) {
             return false;
         }
+
+        for (const auto& name : names) {
+            struct zip_stat file_stat {};
+            if (zip_stat(zip.get(), name.data(), 0, &file_stat)) {
+                std::cerr << "Failed to find <" << name << "> in archive" << std::endl;
+                return false;
+            }
+            if (!is_inside_target(name)) {
+                std::cerr << "Archive entry <" << name << "> points outside of target directory" << std::endl;
+                return false;
+            }
+            entries.push_back({ file_stat.index, name, file_stat.size, file_stat.crc });
+        }
     }
 
-    return true;
+    return extract_entries(zip_file, target, entries, threads);
 }
@@ -18,8 +18,13 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
 
 class zip_extract final {
 public:
     static bool extract(const std::filesystem::path& zip_file, const std::filesystem::path& target);
+    static bool extract(const std::filesystem::path& zip_file, const std::filesystem::path& target, const std::function<bool(const std::string&)>& filter, const int& threads);
+    static bool extract(const std::filesystem::path& zip_file, const std::filesystem::path& target, const std::vector<std::string>& entries, const int& threads);
 };
@@ -0,0 +1,99 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "zip-reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <zip.h>
+
+template <typename T>
+using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
+
+zip_reader::zip_reader(const std::filesystem::path& zip_file) {
+    int error = 0;
+    archive = deleted_unique_ptr<zip_t>(zip_open(zip_file.string().data(), ZIP_RDONLY, &error), [](auto* z) {
+        if (z != nullptr) {
+            zip_discard(z);
+        }
+    });
+    if (!archive) {
+        zip_error_t zip_error;
+        zip_error_init_with_code(&zip_error, error);
+        std::cerr << "Failed to open archive <" << zip_file.filename().string() << ">: " << zip_error_strerror(&zip_error) << std::endl;
+        zip_error_fini(&zip_error);
+        return;
+    }
+
+    const auto& entries = zip_get_num_entries(archive.get(), 0);
+    for (zip_int64_t i = 0; i < entries; ++i) {
+        struct zip_stat file_stat {};
+        if (zip_stat_index(archive.get(), i, 0, &file_stat) || !(file_stat.valid & ZIP_STAT_NAME)) {
+            continue;
+        }
+        if ((file_stat.name[0] != '\0') && (file_stat.name[strlen(file_stat.name) - 1] == '/')) {
+            continue;
+        }
+        names.emplace_back(file_stat.name);
+    }
+}
+
+bool zip_reader::is_open() const {
+    return static_cast<bool>(archive);
+}
+
+const std::vector<std::string>& zip_reader::entries() const {
+    return names;
+}
+
+bool zip_reader::contains(const std::string& name) const {
+    return std::find(names.cbegin(), names.cend(), name) != names.cend();
+}
+
+bool zip_reader::read(const std::string& name, std::string& content) const {
+    if (!archive) {
+        return false;
+    }
+
+    std::lock_guard lock(mutex);
+
+    struct zip_stat file_stat {};
+    if (zip_stat(archive.get(), name.data(), 0, &file_stat) || !(file_stat.valid & ZIP_STAT_SIZE)) {
+        std::cerr << "Failed to find <" << name << "> in archive" << std::endl;
+        return false;
+    }
+
+    const deleted_unique_ptr<zip_file_t> file(zip_fopen_index(archive.get(), file_stat.index, 0), [](auto* f) {
+        if (f != nullptr) {
+            zip_fclose(f);
+        }
+    });
+    if (!file) {
+        std::cerr << "Failed to open <" << name << "> in archive: " << zip_strerror(archive.get()) << std::endl;
+        return false;
+    }
+
+    content.resize(file_stat.size, '\0');
+    if (zip_fread(file.get(), content.data(), file_stat.size) != static_cast<zip_int64_t>(file_stat.size)) {
+        std::cerr << "Failed to read <" << name << "> from archive: " << zip_file_strerror(file.get()) << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,44 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct zip;
+
+class zip_reader final {
+public:
+    explicit zip_reader(const std::filesystem::path& zip_file);
+    ~zip_reader() = default;
+    zip_reader(const zip_reader&) = delete;
+    zip_reader& operator=(const zip_reader&) = delete;
+
+    [[nodiscard]] bool is_open() const;
+    [[nodiscard]] const std::vector<std::string>& entries() const;
+    [[nodiscard]] bool contains(const std::string& name) const;
+    [[nodiscard]] bool read(const std::string& name, std::string& content) const;
+private:
+    std::unique_ptr<struct zip, std::function<void(struct zip*)>> archive;
+    std::vector<std::string> names;
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,459 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "zip-writer.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <zip.h>
+
+template <typename T>
+using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
+
+namespace {
+// range of the spill file, libzip keeps sources of all entries open until the archive is written,
+// so they share one stream instead of opening a file each
+class spill_source final {
+public:
+    spill_source(std::ifstream& stream, const uint64_t& offset, const uint64_t& size) :
+        stream(&stream), offset(offset), size(size) {
+        zip_error_init(&error);
+    }
+    ~spill_source() {
+        zip_error_fini(&error);
+    }
+    spill_source(const spill_source&) = delete;
+    spill_source& operator=(const spill_source&) = delete;
+
+    std::ifstream* stream;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t position = 0;
+    zip_error_t error;
+};
+
+zip_int64_t read_spill(void* userdata, void* data, zip_uint64_t length, zip_source_cmd_t command) {
+    auto* source = static_cast<spill_source*>(userdata);
+    switch (command) {
+    case ZIP_SOURCE_OPEN:
+        source->position = 0;
+        return 0;
+    case ZIP_SOURCE_READ: {
+        const auto count = std::min<uint64_t>(length, source->size - source->position);
+        if (count == 0) {
+            return 0;
+        }
+        source->stream->clear();
+        if (!source->stream->seekg(static_cast<std::streamoff>(source->offset + source->position)) ||
+            !source->stream->read(static_cast<char*>(data), static_cast<std::streamsize>(count))) {
+            zip_error_set(&source->error, ZIP_ER_READ, 0);
+            return -1;
+        }
+        source->position += count;
+        return static_cast<zip_int64_t>(count);
+    }
+    case ZIP_SOURCE_CLOSE:
+    case ZIP_SOURCE_FREE:
+        return 0;
+    case ZIP_SOURCE_STAT: {
+        if (length < sizeof(zip_stat_t)) {
+            zip_error_set(&source->error, ZIP_ER_INVAL, 0);
+            return -1;
+        }
+        auto* stat = static_cast<zip_stat_t*>(data);
+        zip_stat_init(stat);
+        stat->size = source->size;
+        stat->valid |= ZIP_STAT_SIZE;
+        return sizeof(zip_stat_t);
+    }
+    case ZIP_SOURCE_ERROR:
+        return zip_error_to_data(&source->error, data, length);
+    case ZIP_SOURCE_SEEK: {
+        const auto position = zip_source_seek_compute_offset(source->position, source->size, data, length, &source->error);
+        if (position < 0) {
+            return -1;
+        }
+        source->position = static_cast<uint64_t>(position);
+        return 0;
+    }
+    case ZIP_SOURCE_TELL:
+        return static_cast<zip_int64_t>(source->position);
+    case ZIP_SOURCE_SUPPORTS:
+        return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT, ZIP_SOURCE_ERROR,
+            ZIP_SOURCE_FREE, ZIP_SOURCE_SEEK, ZIP_SOURCE_TELL, ZIP_SOURCE_SUPPORTS, -1);
+    default:
+        zip_error_set(&source->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+}
+}
+
+class zip_writer::entry {
+public:
+    std::string name;
+    std::filesystem::path file;
+    std::string content;
+    zip_compression compression;
+    // single entry archive or, with a single thread, uncompressed content in the spill file
+    bool spilled = false;
+    bool compressed = false;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::unique_ptr<spill_source> source;
+};
+
+namespace {
+zip_int32_t to_zip_method(const compression_method& method) {
+    switch (method) {
+    case compression_method::store:
+        return ZIP_CM_STORE;
+    case compression_method::zstd:
+        return ZIP_CM_ZSTD;
+    case compression_method::deflate:
+    default:
+        return ZIP_CM_DEFLATE;
+    }
+}
+
+zip_compression find_compression(const std::filesystem::path& file, const std::map<std::string, zip_compression>& compression) {
+    auto extension = file.extension().string();
+    if (!extension.empty()) {
+        extension.erase(0, 1);
+    }
+
+    auto it = compression.find(extension);
+    if (it == compression.end()) {
+        it = compression.find("*");
+    }
+    return it == compression.end() ? zip_compression() : it->second;
+}
+
+bool set_compression(zip_t* zip, const zip_uint64_t& index, const std::string& name, const zip_compression& compression) {
+    if (zip_set_file_compression(zip, index, to_zip_method(compression.method), static_cast<zip_uint32_t>(compression.level)) < 0) {
+        std::cerr << "Failed to set compression for <" << name << ">: " << zip_strerror(zip) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool add_source(zip_t* zip, zip_source_t* source, const std::string& name, const zip_compression& compression) {
+    if (source == nullptr) {
+        std::cerr << "Failed to open <" << name << ">: " << zip_strerror(zip) << std::endl;
+        return false;
+    }
+    const auto& index = zip_file_add(zip, name.data(), source, ZIP_FL_ENC_UTF_8);
+    if (index < 0) {
+        zip_source_free(source);
+        std::cerr << "Failed to add file <" << name << "> to archive : " << zip_strerror(zip) << std::endl;
+        return false;
+    }
+    return set_compression(zip, index, name, compression);
+}
+
+zip_source_t* uncompressed_source(zip_t* zip, const std::filesystem::path& file, const std::string& content) {
+    return file.empty() ?
+        zip_source_buffer(zip, content.data(), content.size(), 0) :
+        zip_source_file(zip, file.string().data(), 0, 0);
+}
+
+// compresses single entry into in-memory archive, so it can be copied into the resulting one without recompression
+bool compress_entry(const std::string& name, const std::filesystem::path& file, const std::string& content, const zip_compression& compression, std::string& compressed) {
+    zip_error_t error;
+    zip_error_init(&error);
+    const deleted_unique_ptr<zip_source_t> buffer(zip_source_buffer_create(nullptr, 0, 0, &error), [](auto* s) {
+        if (s != nullptr) {
+            zip_source_free(s);
+        }
+    });
+    if (!buffer) {
+        std::cerr << "Failed to compress <" << name << ">: " << zip_error_strerror(&error) << std::endl;
+        zip_error_fini(&error);
+        return false;
+    }
+
+    auto* zip = zip_open_from_source(buffer.get(), ZIP_TRUNCATE, &error);
+    if (zip == nullptr) {
+        std::cerr << "Failed to compress <" << name << ">: " << zip_error_strerror(&error) << std::endl;
+        zip_error_fini(&error);
+        return false;
+    }
+    zip_source_keep(buffer.get());
+
+    if (!add_source(zip, uncompressed_source(zip, file, content), name, compression)) {
+        zip_discard(zip);
+        return false;
+    }
+    if (zip_close(zip) < 0) {
+        std::cerr << "Failed to compress <" << name << ">: " << zip_strerror(zip) << std::endl;
+        zip_discard(zip);
+        return false;
+    }
+
+    zip_stat_t stat;
+    zip_stat_init(&stat);
+    if (zip_source_stat(buffer.get(), &stat) < 0 || zip_source_open(buffer.get()) < 0) {
+        std::cerr << "Failed to read compressed <" << name << ">" << std::endl;
+        return false;
+    }
+    compressed.resize(static_cast<size_t>(stat.size));
+    const auto& read = zip_source_read(buffer.get(), compressed.data(), stat.size);
+    zip_source_close(buffer.get());
+    if (read < 0 || static_cast<zip_uint64_t>(read) != stat.size) {
+        std::cerr << "Failed to read compressed <" << name << ">" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+}
+
+zip_writer::zip_writer(const std::filesystem::path& zip_file, const std::map<std::string, zip_compression>& compression, const int& threads) :
+    compression(compression), zip_file(zip_file) {
+    for (auto& [extension, settings] : this->compression) {
+        if (!zip_compression_method_supported(to_zip_method(settings.method), 1)) {
+            std::cerr << "Compression method for <" << extension << "> files is not supported, deflate is used instead" << std::endl;
+            settings.method = compression_method::deflate;
+            settings.level = 0;
+        }
+    }
+
+    int error = 0;
+    archive = deleted_unique_ptr<zip_t>(zip_open(zip_file.string().data(), ZIP_CREATE | ZIP_EXCL, &error), [](auto* z) {
+        if (z != nullptr) {
+            zip_discard(z);
+        }
+    });
+    if (!archive) {
+        zip_error_t zip_error;
+        zip_error_init_with_code(&zip_error, error);
+        std::cerr << "Failed to create archive <" << zip_file.filename().string() << ">: " << zip_error_strerror(&zip_error) << std::endl;
+        zip_error_fini(&zip_error);
+        return;
+    }
+
+    spill_file = zip_file;
+    spill_file += ".entries.tmp";
+    spill_stream.open(spill_file, std::ios::binary | std::ios::trunc);
+    if (!spill_stream) {
+        std::cerr << "Failed to create temporary file for archive <" << zip_file.filename().string() << ">" << std::endl;
+        archive.reset();
+        return;
+    }
+
+    // with a single thread entries are compressed by libzip while the archive is written
+    if (threads > 1) {
+        for (auto i = 0; i < threads; ++i) {
+            workers.emplace_back(&zip_writer::compress, this);
+        }
+    }
+}
+
+zip_writer::~zip_writer() {
+    {
+        std::lock_guard lock(mutex);
+        closing = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    remove_spill();
+}
+
+bool zip_writer::is_open() const {
+    return static_cast<bool>(archive);
+}
+
+bool zip_writer::add(const std::string& name, std::string content) {
+    auto new_entry = std::make_unique<entry>();
+    new_entry->name = name;
+    new_entry->content = std::move(content);
+    new_entry->compression = find_compression(name, compression);
+    return add_entry(std::move(new_entry));
+}
+
+bool zip_writer::add_file(const std::filesystem::path& file) {
+    if (!is_regular_file(file)) {
+        std::cerr << "Failed to open file <" << file.filename().string() << ">" << std::endl;
+        return false;
+    }
+
+    auto new_entry = std::make_unique<entry>();
+    new_entry->name = file.filename().string();
+    new_entry->file = file;
+    new_entry->compression = find_compression(file, compression);
+    return add_entry(std::move(new_entry));
+}
+
+bool zip_writer::add_entry(std::unique_ptr<entry> new_entry) {
+    if (!archive) {
+        return false;
+    }
+
+    // with a single thread there is nothing to wait for, content is moved out of memory right away
+    if (workers.empty() && new_entry->file.empty()) {
+        const auto spilled = spill(*new_entry, new_entry->content, false);
+        std::string().swap(new_entry->content);
+        if (!spilled) {
+            return false;
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        if (closing) {
+            return false;
+        }
+        entries.emplace_back(std::move(new_entry));
+    }
+    condition.notify_one();
+
+    return true;
+}
+
+bool zip_writer::spill(entry& e, const std::string& data, const bool& compressed) {
+    std::lock_guard lock(spill_mutex);
+    if (!spill_stream.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+        std::cerr << "Failed to write <" << e.name << "> to temporary file" << std::endl;
+        return false;
+    }
+    e.spilled = true;
+    e.compressed = compressed;
+    e.offset = spill_size;
+    e.size = data.size();
+    spill_size += data.size();
+    return true;
+}
+
+void zip_writer::remove_spill() {
+    if (spill_file.empty()) {
+        return;
+    }
+    spill_stream.close();
+    spill_reader.close();
+    std::error_code error;
+    std::filesystem::remove(spill_file, error);
+}
+
+void zip_writer::compress() {
+    while (true) {
+        entry* e;
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() {
+                return next < entries.size() || closing;
+            });
+            if (next >= entries.size()) {
+                return;
+            }
+            e = entries[next++].get();
+        }
+
+        std::string compressed;
+        const auto result = compress_entry(e->name, e->file, e->content, e->compression, compressed);
+        std::string().swap(e->content);
+        if (!result || !spill(*e, compressed, true)) {
+            std::lock_guard lock(mutex);
+            failed = true;
+        }
+    }
+}
+
+bool zip_writer::close() {
+    if (!archive) {
+        return false;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        closing = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    spill_stream.close();
+    if (failed || !spill_stream) {
+        archive.reset();
+        return false;
+    }
+
+    spill_reader.open(spill_file, std::ios::binary);
+    if (!spill_reader) {
+        std::cerr << "Failed to read temporary file of archive <" << zip_file.filename().string() << ">" << std::endl;
+        archive.reset();
+        return false;
+    }
+
+    for (const auto& e : entries) {
+        // files added with a single thread are compressed by libzip straight from the disk
+        if (!e->spilled) {
+            if (!add_source(archive.get(), uncompressed_source(archive.get(), e->file, e->content), e->name, e->compression)) {
+                archive.reset();
+                return false;
+            }
+            continue;
+        }
+
+        e->source = std::make_unique<spill_source>(spill_reader, e->offset, e->size);
+
+        zip_error_t error;
+        zip_error_init(&error);
+        auto* spilled = zip_source_function_create(&read_spill, e->source.get(), &error);
+        if (!e->compressed) {
+            zip_error_fini(&error);
+            if (!add_source(archive.get(), spilled, e->name, e->compression)) {
+                archive.reset();
+                return false;
+            }
+            continue;
+        }
+
+        auto* source = spilled == nullptr ? nullptr : zip_open_from_source(spilled, ZIP_RDONLY, &error);
+        if (source == nullptr) {
+            if (spilled != nullptr) {
+                zip_source_free(spilled);
+            }
+            std::cerr << "Failed to open compressed <" << e->name << ">: " << zip_error_strerror(&error) << std::endl;
+            zip_error_fini(&error);
+            archive.reset();
+            return false;
+        }
+        sources.emplace_back(source, [](auto* z) {
+            zip_discard(z);
+        });
+
+        if (!add_source(archive.get(), zip_source_zip(archive.get(), source, 0, ZIP_FL_COMPRESSED, 0, -1), e->name, e->compression)) {
+            archive.reset();
+            return false;
+        }
+    }
+
+    if (zip_close(archive.get()) < 0) {
+        std::cerr << "Failed to write archive <" << zip_file.filename().string() << ">: " << zip_strerror(archive.get()) << std::endl;
+        archive.reset();
+        return false;
+    }
+    archive.release();
+    sources.clear();
+    remove_spill();
+
+    return true;
+}
@@ -0,0 +1,76 @@
+// This file is part of BOINC.
+// https://boinc.berkeley.edu
+// Copyright (C) 2023 University of California
+//
+// BOINC is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation,
+// either version 3 of the License, or (at your option) any later version.
+//
+// BOINC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with BOINC.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zip-compression.h"
+
+struct zip;
+
+// Entries are compressed by background threads as soon as they are added,
+// the archive itself is written on close. Finished entries are kept in a temporary
+// file next to the archive until then, so memory usage does not depend on their number.
+class zip_writer final {
+public:
+    // compression is looked up by file extension without the leading dot, "*" matches any other file
+    zip_writer(const std::filesystem::path& zip_file, const std::map<std::string, zip_compression>& compression, const int& threads);
+    ~zip_writer();
+    zip_writer(const zip_writer&) = delete;
+    zip_writer& operator=(const zip_writer&) = delete;
+
+    [[nodiscard]] bool is_open() const;
+    [[nodiscard]] bool add(const std::string& name, std::string content);
+    [[nodiscard]] bool add_file(const std::filesystem::path& file);
+    [[nodiscard]] bool close();
+private:
+    class entry;
+
+    [[nodiscard]] bool add_entry(std::unique_ptr<entry> new_entry);
+    [[nodiscard]] bool spill(entry& e, const std::string& data, const bool& compressed);
+    void remove_spill();
+    void compress();
+
+    std::map<std::string, zip_compression> compression;
+    std::filesystem::path spill_file;
+    std::ofstream spill_stream;
+    // libzip reads entries from it while the archive is written, so it has to outlive the archive
+    std::ifstream spill_reader;
+    uint64_t spill_size = 0;
+    std::mutex spill_mutex;
+    std::vector<std::unique_ptr<entry>> entries;
+    std::vector<std::unique_ptr<struct zip, std::function<void(struct zip*)>>> sources;
+    std::unique_ptr<struct zip, std::function<void(struct zip*)>> archive;
+    std::filesystem::path zip_file;
+    std::vector<std::thread> workers;
+    size_t next = 0;
+    bool closing = false;
+    bool failed = false;
+    std::mutex mutex;
+    std::condition_variable condition;
+};